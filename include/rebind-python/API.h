@@ -7,15 +7,111 @@
 #include "Object.h"
 
 #include <rebind/Document.h>
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <unordered_map>
+#include <vector>
 
 namespace rebind {
 
-extern std::unordered_map<TypeIndex, std::string> type_names;
+/******************************************************************************/
+
+/// Incremented whenever any Registry changes, to invalidate caches of its lookups
+inline std::atomic<std::size_t> RegistryVersion{0};
+
+/// Read-mostly map which is safe to use from many threads without the GIL. Lookups read the current
+/// immutable map through an atomic pointer, without a lock or reference count. Writers, which are rare,
+/// copy the map under the mutex and publish the copy. Superseded maps are kept, since readers may still
+/// be using them, until the registry is cleared; values found are therefore valid until then
+template <class K, class V>
+class Registry {
+public:
+    using Map = std::unordered_map<K, V>;
+
+private:
+    std::atomic<Map const *> current{nullptr};
+    std::vector<Map const *> retired;
+    std::mutex mutex;
+
+    static void release(Map const *m) noexcept {
+        if (!Py_IsInitialized()) return; // too late to release its objects
+        if (PyGILState_Check()) return delete m;
+        auto s = PyGILState_Ensure();
+        delete m;
+        PyGILState_Release(s);
+    }
+
+    void publish(Map &&m) {
+        retired.reserve(retired.size() + 1);
+        if (auto old = current.exchange(new Map(std::move(m)), std::memory_order_acq_rel)) retired.push_back(old);
+        RegistryVersion.fetch_add(1, std::memory_order_release);
+    }
+
+public:
+    Registry(std::initializer_list<std::pair<K const, V>> init={}) {publish(Map(init));}
+    Registry(Registry const &) = delete;
+    Registry &operator=(Registry const &) = delete;
+
+    ~Registry() {
+        release(current.load(std::memory_order_acquire));
+        for (auto m : retired) release(m);
+    }
+
+    /// The current map, valid until the registry is cleared
+    Map const &snapshot() const noexcept {return *current.load(std::memory_order_acquire);}
+
+    /// Value for k in the current map, or null if there is none
+    V const *find(K const &k) const {
+        auto const &m = snapshot();
+        auto it = m.find(k);
+        return it == m.end() ? nullptr : &it->second;
+    }
+
+    /// Apply f to a copy of the current map and publish the result
+    template <class F>
+    void update(F &&f) {
+        std::lock_guard<std::mutex> lk(mutex);
+        Map next(snapshot());
+        f(next);
+        publish(std::move(next));
+    }
+
+    void insert_or_assign(K k, V v) {update([&](Map &m) {m.insert_or_assign(std::move(k), std::move(v));});}
+
+    void emplace(K k, V v) {update([&](Map &m) {m.emplace(std::move(k), std::move(v));});}
+
+    /// Publish an empty map and free all earlier ones. No other thread may be using the registry
+    void clear() {
+        std::vector<Map const *> old;
+        {
+            std::lock_guard<std::mutex> lk(mutex);
+            publish(Map());
+            old.swap(retired);
+        }
+        for (auto m : old) release(m); // outside the lock, since releasing objects may run Python code
+    }
+};
+
+/******************************************************************************/
+
+extern Registry<TypeIndex, std::string> type_names;
 extern Object TypeError, UnionType;
-extern std::unordered_map<Object, Object> output_conversions, input_conversions, type_translations;
-extern std::unordered_map<std::type_index, Object> python_types;
+extern Registry<Object, Object> output_conversions, input_conversions, type_translations;
+extern Registry<TypeIndex, Object> python_types;
+/// Whether bytes casts of binary and string views give a read-only memoryview instead of a copy
+extern std::atomic<bool> ZeroCopyBytes;
+
+/// Registered conversions for one Python type (null if none)
+struct TypeConverters {
+    Object input;       //< input_conversions entry for objects of the type
+    Object translation; //< type_translations entry for the type as a cast target
+    Object output;      //< output_conversions entry for the type as a cast target
+};
+
+/// Conversions for a type, resolved once per thread and type version and reused until a registry changes
+TypeConverters type_converters(PyTypeObject *) noexcept;
 
 /******************************************************************************/
 
@@ -24,9 +120,44 @@ std::string_view from_unicode(PyObject *o);
 template <class ...Ts>
 std::nullptr_t type_error(char const *s, Ts ...ts) {PyErr_Format(TypeError, s, ts...); return nullptr;}
 
+/******************************************************************************/
+
+/// Layout of an array exported through the buffer protocol. It must not change while exports is nonzero,
+/// since the Py_buffers handed out point into shape_stride
+struct BufferLayout {
+    std::vector<Py_ssize_t> shape_stride;
+    std::size_t exports = 0;
+    std::size_t n_elem = 0;
+    void *data = nullptr;
+    std::type_info const *type = nullptr;
+    bool mutate = false;
+    bool swap = false;
+
+    /// Point the layout at an array
+    void view(ArrayView const &a) {
+        n_elem = a.layout.n_elem();
+        data = const_cast<void *>(a.data.pointer());
+        type = &a.data.type();
+        mutate = a.data.mutate();
+        swap = a.data.swapped();
+        shape_stride.clear();
+        for (std::size_t i = 0; i != a.layout.depth(); ++i)
+            shape_stride.emplace_back(a.layout.shape(i));
+        auto const item = Buffer::itemsize(*type);
+        for (std::size_t i = 0; i != a.layout.depth(); ++i)
+            shape_stride.emplace_back(a.layout.stride(i) * item);
+    }
+
+    /// Fill a Py_buffer exporting this layout on behalf of self; returns 0 or sets a Python error and returns -1
+    int export_to(PyObject *self, Py_buffer *view, int flags) noexcept;
+};
+
+/******************************************************************************/
+
 struct Var : Variable {
     using Variable::Variable;
     Object ward = {};
+    BufferLayout buffer; //< layout cached while the held value is exported through the buffer protocol
 
     ~Var() {DUMP("~Var() ", ward, ", refcount = ", reference_count(ward));}
 };
@@ -36,31 +167,22 @@ struct Holder<Variable> : Holder<Var> {};
 
 /******************************************************************************/
 
-struct ArrayBuffer {
-    std::vector<Py_ssize_t> shape_stride;
-    std::size_t exports = 0;
-    std::size_t n_elem;
+/// Python buffer exporting an array. The memory is kept alive either by a Python base object
+/// or, for a C++ temporary, by the owned Variable it was taken from
+struct ArrayBuffer : BufferLayout {
     Object base;
-    void *data;
-    std::type_info const * type;
-    bool mutate;
+    Variable owner;
 
     ArrayBuffer() noexcept = default;
-    ArrayBuffer(ArrayView const &a, Object const &b) : n_elem(a.layout.n_elem()),
-        base(b), data(const_cast<void *>(a.data.pointer())), type(&a.data.type()), mutate(a.data.mutate()) {
-        for (std::size_t i = 0; i != a.layout.depth(); ++i)
-            shape_stride.emplace_back(a.layout.shape(i));
-        auto const item = Buffer::itemsize(*type);
-        for (std::size_t i = 0; i != a.layout.depth(); ++i)
-            shape_stride.emplace_back(a.layout.stride(i) * item);
-    }
+    ArrayBuffer(ArrayView const &a, Object const &b) : base(b) {view(a);}
 };
 
 /******************************************************************************/
 
 Variable variable_reference_from_object(Object o);
 void args_from_python(Sequence &s, Object const &pypack);
-bool object_response(Variable &v, TypeIndex t, Object o);
+void args_from_python(Sequence &s, PyObject *const *args, std::size_t n);
+bool object_response(Variable &v, TypeIndex t, Object const &o);
 
 template <Qualifier Q>
 struct Response<Object, Q> {
@@ -82,19 +204,18 @@ struct Response<Object, Value> {
         DUMP("trying to get reference from unqualified Object, type = ", t);
         if (!o) return false;
         DUMP("reference count = ", reference_count(o));
-        Object type = Object(reinterpret_cast<PyObject *>((+o)->ob_type), true);
-        if (auto p = input_conversions.find(type); p != input_conversions.end()) {
+        if (auto f = type_converters(Py_TYPE(+o)).input) {
             Object guard(+o, false); // PyObject_CallFunctionObjArgs increments reference
-            o = Object::from(PyObject_CallFunctionObjArgs(+p->second, +o, nullptr));
-            type = Object(reinterpret_cast<PyObject *>((+o)->ob_type), true);
+            o = Object::from(PyObject_CallFunctionObjArgs(+f, +o, nullptr));
+            if (!o) return false;
         }
         DUMP("reference count 2 = ", reference_count(o));
-        bool ok = object_response(v, t, std::move(o));
+        bool ok = object_response(v, t, o);
         DUMP("got response from object, ok = ", ok);
         if (!ok) { // put diagnostic for the source type
-            auto o = Object::from(PyObject_Repr(+type));
-            DUMP("setting object error description: ", from_unicode(o));
-            v = {Type<std::string>(), from_unicode(o)};
+            auto repr = Object::from(PyObject_Repr(reinterpret_cast<PyObject *>(Py_TYPE(+o))));
+            DUMP("setting object error description: ", from_unicode(repr));
+            v = {Type<std::string>(), from_unicode(repr)};
         }
         return ok;
     }
@@ -164,9 +285,21 @@ void map_iterable(Object iterable, F &&f) {
 
 /******************************************************************************/
 
+/// Frame of a Python thread, outliving any call, which takes the GIL on lock() from any
+/// thread with PyGILState_Ensure. It is shared by all persisted PythonFrames
+struct PersistentPythonFrame final : Frame {
+    int lock() override {
+        if (!Py_IsInitialized()) throw DispatchError("Python interpreter is not running");
+        return PyGILState_Ensure();
+    }
+
+    void unlock(int s) noexcept override {PyGILState_Release(static_cast<PyGILState_STATE>(s));}
+};
+
+/******************************************************************************/
+
 /// RAII release of Python GIL
 struct PythonFrame final : Frame {
-    std::mutex mutex;
     PyThreadState *state = nullptr;
     bool no_gil;
 
@@ -177,28 +310,25 @@ struct PythonFrame final : Frame {
         if (no_gil && !state) state = PyEval_SaveThread(); // release GIL
     }
 
-    std::shared_ptr<Frame> operator()(std::shared_ptr<Frame> &&t) override {
-        DUMP("suspended Python ", bool(t));
-        if (no_gil || state) return std::move(t); // return this
-        else return std::make_shared<PythonFrame>(no_gil); // return a new frame
+    // reacquire the GIL if the call released it; PyGILState handles nesting and other threads.
+    // Otherwise the calling thread holds the GIL, so another thread could never take it
+    int lock() override {
+        if (state) return PyGILState_Ensure();
+        if (!PyGILState_Check()) throw DispatchError("Python can only be called from another thread in a call with gil=False");
+        return -1;
     }
 
-    // acquire GIL; lock mutex to prevent multiple threads trying to get the thread going
-    void acquire() noexcept {if (state) {mutex.lock(); PyEval_RestoreThread(state);}}
-    // release GIL; unlock mutex
-    void release() noexcept {if (state) {state = PyEval_SaveThread(); mutex.unlock();}}
-
-    ~PythonFrame() {if (state) PyEval_RestoreThread(state);}
-};
-
-/******************************************************************************/
+    void unlock(int s) noexcept override {if (s != -1) PyGILState_Release(static_cast<PyGILState_STATE>(s));}
 
-/// RAII reacquisition of Python GIL
-struct ActivePython {
-    PythonFrame &lock;
+    std::shared_ptr<Frame> persist() override {
+        static auto const frame = std::make_shared<PersistentPythonFrame>();
+        return frame;
+    }
 
-    ActivePython(PythonFrame &u) : lock(u) {lock.acquire();}
-    ~ActivePython() {lock.release();}
+    ~PythonFrame() {
+        detach(); // wait for escaped callbacks using the frame, which may hold the GIL
+        if (state) PyEval_RestoreThread(state);
+    }
 };
 
 /******************************************************************************/
@@ -216,12 +346,29 @@ struct PythonFunction {
             throw python_error(type_error("expected tuple or None but got %R", (+signature)->ob_type));
     }
 
+    PythonFunction(PythonFunction const &) = default;
+    PythonFunction(PythonFunction &&) noexcept = default;
+
+    /// A PersistentCallback may release the last reference from a thread without the GIL
+    ~PythonFunction() {
+        if (!function && !signature) return;
+        if (!Py_IsInitialized()) { // too late to release them, e.g. from a static Callback at exit
+            function.ptr = signature.ptr = nullptr;
+            return;
+        }
+        if (PyGILState_Check()) return;
+        auto s = PyGILState_Ensure();
+        xdecref(std::exchange(function.ptr, nullptr));
+        xdecref(std::exchange(signature.ptr, nullptr));
+        PyGILState_Release(s);
+    }
+
     /// Run C++ functor; logs non-ClientError and rethrows all exceptions
-    Variable operator()(Caller c, Sequence args) const {
+    std::optional<Variable> operator()(Caller c, Sequence &args, Dispatch &) const {
         DUMP("calling python function");
-        auto p = c.target<PythonFrame>();
-        if (!p) throw DispatchError("Python context is expired or invalid");
-        ActivePython lk(*p);
+        FrameLock lk(c);
+        if (!lk.target<PythonFrame>() && !lk.target<PersistentPythonFrame>())
+            throw DispatchError("Python context is expired or invalid");
         Object o = args_to_python(std::move(args), signature);
         if (!o) throw python_error();
         return Variable(Object::from(PyObject_CallObject(function, o)));
@@ -246,7 +393,9 @@ PyObject *raw_object(F &&f) noexcept {
         Object o = static_cast<F &&>(f)();
         xincref(+o);
         return +o;
-    } catch (PythonError const &) {
+    } catch (PythonError const &e) {
+        // the error indicator is lost if the exception was raised on another thread
+        if (!PyErr_Occurred()) PyErr_SetString(PyExc_RuntimeError, e.what());
         return nullptr;
     } catch (std::bad_alloc const &e) {
         PyErr_SetString(PyExc_MemoryError, "C++: out of memory (std::bad_alloc)");
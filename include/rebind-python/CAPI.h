@@ -5,6 +5,7 @@
 #pragma GCC diagnostic pop
 
 #include <functional>
+#include <cstddef>
 #include <rebind/Type.h>
 #include <rebind/Common.h>
 #include <rebind/Error.h>
@@ -41,6 +42,8 @@ struct Holder {
     static inline PyTypeObject type;
     PyObject_HEAD // 16 bytes for the ref count and the type object
     T value; // I think stack is OK because this object is only casted to anyway.
+    // Python objects are allocated by PyObject_Malloc, which only guarantees fundamental alignment
+    static_assert(alignof(T) <= alignof(std::max_align_t), "REBIND_STORAGE_ALIGN is over-aligned for a Python object");
 };
 
 template <class T>
@@ -79,8 +82,51 @@ void tp_delete(PyObject *o) noexcept {
 
 /******************************************************************************/
 
+#if PY_VERSION_HEX >= 0x03090000
+#   define REBIND_VECTORCALL
+#endif
+
+#ifdef REBIND_VECTORCALL
+
+/// The PEP 590 vectorcall function pointer is stored directly after Holder<T>
+template <class T>
+vectorcallfunc & vectorcall_slot(PyObject *o) noexcept {
+    return *reinterpret_cast<vectorcallfunc *>(reinterpret_cast<char *>(o) + sizeof(Holder<T>));
+}
+
+template <class T, vectorcallfunc F>
+PyObject *tp_new_vectorcall(PyTypeObject *subtype, PyObject *args, PyObject *kws) noexcept {
+    PyObject *o = tp_new<T>(subtype, args, kws);
+    if (o) vectorcall_slot<T>(o) = F;
+    return o;
+}
+
+/// Turn on the vectorcall protocol for a type made by type_definition(); tp_call is still used for tuple calls
+template <class T, vectorcallfunc F>
+void define_vectorcall(PyTypeObject &o) noexcept {
+    o.tp_basicsize = sizeof(Holder<T>) + sizeof(vectorcallfunc);
+    o.tp_vectorcall_offset = sizeof(Holder<T>);
+    o.tp_new = tp_new_vectorcall<T, F>;
+    o.tp_flags |= Py_TPFLAGS_HAVE_VECTORCALL;
+}
+
+#endif
+
+/******************************************************************************/
+
+/// Parsed PEP 3118 format of a single (non-struct) buffer item
+struct BufferFormat {
+    std::type_info const *type = nullptr; //< element type, or null if unsupported
+    std::size_t itemsize = 0; //< bytes per item, including the repeat count
+    std::size_t count = 1;    //< repeat count, e.g. 3 for "3d"
+    bool swap = false;        //< whether elements are stored in non-native byte order
+
+    explicit operator bool() const noexcept {return type;}
+};
+
+/******************************************************************************/
+
 class Buffer {
-    static Vector<std::pair<std::string_view, std::type_info const *>> formats;
     bool valid;
 
 public:
@@ -100,6 +146,9 @@ public:
         if (valid) DUMP("after buffer", reference_count(o), view.obj == o);
     }
 
+    /// Parse a format string, including byte order prefixes, standard sizes, "Z" complex codes and repeat counts
+    static BufferFormat parse(std::string_view s) noexcept;
+    /// Element type of a format string (excludes constness), or void if unsupported
     static std::type_info const & format(std::string_view s);
     static std::string_view format(std::type_info const &t);
     static std::size_t itemsize(std::type_info const &t);
@@ -28,7 +28,7 @@ Variable variable_invoke(F const &f, Ts &&... ts) {
 template <class F, class ...Ts>
 Variable caller_invoke(std::true_type, F const &f, Caller &&c, Ts &&...ts) {
     c.enter();
-    return variable_invoke(f, std::move(c), static_cast<Ts &&>(ts)...);
+    return variable_invoke(f, c.escape(), static_cast<Ts &&>(ts)...);
 }
 
 template <class F, class ...Ts>
@@ -77,6 +77,37 @@ std::is_convertible<T, C> has_head(Pack<R, T, Ts...>);
 
 /******************************************************************************/
 
+/// Holder of a requested argument: std::optional<T> for values, or a pointer for references
+template <class T>
+using Argument = decltype(std::declval<Variable const &>().request(std::declval<Dispatch &>(), Type<T>()));
+
+template <class T>
+bool put_argument(std::optional<T> &out, std::optional<T> &&t) {
+    if (t) out.emplace(std::move(*t));
+    return bool(out);
+}
+
+template <class T>
+bool put_argument(T *&out, T *t) {return (out = t);}
+
+/// Request each argument in order, stopping at the first failure. Then invoke the function
+/// If an argument could not be converted, return std::nullopt with the reason left in msg
+template <class Ctx, class F, class ...Ts, std::size_t ...Is>
+std::optional<Variable> request_invoke(Ctx ctx, F const &f, Caller &&c, Sequence &args, Dispatch &msg,
+                                       Pack<Ts...>, std::index_sequence<Is...>) {
+    std::tuple<Argument<Ts>...> xs;
+    if (!((msg.index = Is, put_argument(std::get<Is>(xs), args[Is].request(msg, Type<Ts>()))) && ...))
+        return msg.error();
+    return caller_invoke(ctx, f, std::move(c), static_cast<Ts &&>(*std::get<Is>(xs))...);
+}
+
+template <class Ctx, class F, class P>
+std::optional<Variable> request_invoke(Ctx ctx, F const &f, Caller &&c, Sequence &args, Dispatch &msg, P p) {
+    return request_invoke(ctx, f, std::move(c), args, msg, p, typename P::indices());
+}
+
+/******************************************************************************/
+
 // N is the number of trailing optional arguments
 template <std::size_t N, class F, class SFINAE=void>
 struct Adapter {
@@ -84,35 +115,23 @@ struct Adapter {
     using UsesCaller = decltype(has_head<Caller>(SimpleSignature<F>()));
     using AllTypes = decltype(skip_head<1 + int(UsesCaller::value)>(SimpleSignature<F>()));
 
-    template <class P>
-    void call_one(P, Variable &out, Caller &&c, Dispatch &msg, Sequence &args) const {
-        P::indexed([&](auto ...ts) {
-            out = caller_invoke(UsesCaller(), function, std::move(c), cast_index(args, msg, simplify_argument(ts))...);
-        });
-    }
-
     template <std::size_t ...Is>
-    Variable call(Sequence &args, Caller &&c, Dispatch &msg, std::index_sequence<Is...>) const {
-        Variable out;
-        constexpr std::size_t const M = AllTypes::size - 1; // number of total arguments minus 1
+    std::optional<Variable> call(Sequence &args, Caller &&c, Dispatch &msg, std::index_sequence<Is...>) const {
+        std::optional<Variable> out;
         // check the number of arguments given and call with the under-specified arguments
-        ((args.size() == M - Is ? call_one(AllTypes::template slice<0, M - Is>(), out, std::move(c), msg, args) : void()), ...);
+        ((args.size() == AllTypes::size - Is ? void(out = request_invoke(UsesCaller(), function, std::move(c), args, msg,
+            AllTypes::template slice<0, AllTypes::size - Is>())) : void()), ...);
         return out;
     }
 
-    Variable operator()(Caller c, Sequence args) const {
-        auto frame = c();
-        Caller handle(frame);
-        Dispatch msg(handle);
-        if (args.size() == AllTypes::size) // handle fully specified arguments
-            return AllTypes::indexed([&](auto ...ts) {
-                return caller_invoke(UsesCaller(), function, std::move(handle), cast_index(args, msg, simplify_argument(ts))...);
-            });
-        else if (args.size() < AllTypes::size - N)
-            throw WrongNumber(AllTypes::size - N, args.size());
+    /// Call without throwing if the arguments do not match; the reason is left in msg
+    std::optional<Variable> operator()(Caller c, Sequence &args, Dispatch &msg) const {
+        if (args.size() < AllTypes::size - N)
+            return msg.error_number(AllTypes::size - N, args.size());
         else if (args.size() > AllTypes::size)
-            throw WrongNumber(AllTypes::size, args.size()); // try under-specified arguments
-        return call(args, std::move(handle), msg, std::make_index_sequence<N>());
+            return msg.error_number(AllTypes::size, args.size());
+        msg.caller = c;
+        return call(args, std::move(c), msg, std::make_index_sequence<N + 1>());
     }
 };
 
@@ -124,16 +143,13 @@ struct Adapter<0, F, SFINAE> {
     using Ctx = decltype(has_head<Caller>(SimpleSignature<F>()));
     using Sig = decltype(skip_head<1 + int(Ctx::value)>(SimpleSignature<F>()));
 
-    Variable operator()(Caller c, Sequence args) const {
+    /// Call without throwing if the arguments do not match; the reason is left in msg
+    std::optional<Variable> operator()(Caller c, Sequence &args, Dispatch &msg) const {
         DUMP("Adapter<", type_index<F>(), ">::()");
         if (args.size() != Sig::size)
-            throw WrongNumber(Sig::size, args.size());
-        return Sig::indexed([&](auto ...ts) {
-            auto frame = c();
-            Caller handle(frame);
-            Dispatch msg(handle);
-            return caller_invoke(Ctx(), function, std::move(handle), cast_index(args, msg, ts)...);
-        });
+            return msg.error_number(Sig::size, args.size());
+        msg.caller = c;
+        return request_invoke(Ctx(), function, std::move(c), args, msg, Sig());
     }
 };
 
@@ -143,35 +159,33 @@ template <class R, class C>
 struct Adapter<0, R C::*, std::enable_if_t<std::is_member_object_pointer_v<R C::*>>> {
     R C::* function;
 
-    Variable operator()(Caller c, Sequence args) const {
-        if (args.size() != 1) throw WrongNumber(1, args.size());
+    std::optional<Variable> operator()(Caller c, Sequence &args, Dispatch &msg) const {
+        if (args.size() != 1) return msg.error_number(1, args.size());
         auto &s = args[0];
-        auto frame = c();
         DUMP("Adapter<", type_index<R>(), ", ", type_index<C>(), ">::()");
-        Caller handle(frame);
-        Dispatch msg(handle);
+        msg.caller = c;
 
         if (!s.type().matches<C>() || s.qualifier() == Lvalue) {
             DUMP("Adapter<", type_index<R>(), ", ", type_index<C>(), ">::() try &");
             if (auto p = s.request(msg, Type<C &>())) {
-                frame->enter();
-                return {Type<R &>(), std::invoke(function, *p)};
+                c.enter();
+                return Variable(Type<R &>(), std::invoke(function, *p));
             }
         }
 
         DUMP("Adapter<", type_index<R>(), ", ", type_index<C>(), ">::() try const &");
         if (auto p = s.request(msg, Type<C const &>())) {
-            frame->enter();
-            return {Type<R const &>(), std::invoke(function, *p)};
+            c.enter();
+            return Variable(Type<R const &>(), std::invoke(function, *p));
         }
 
         if (auto p = s.request(msg, Type<C>())) {
             DUMP("Adapter<", type_index<R>(), ", ", type_index<C>(), ">::() try &&");
-            frame->enter();
-            return {Type<std::remove_cv_t<R>>(), std::invoke(function, std::move(*p))};
+            c.enter();
+            return Variable(Type<std::remove_cv_t<R>>(), std::invoke(function, std::move(*p)));
         }
 
-        throw std::move(msg).exception();
+        return msg.error();
     }
 };
 
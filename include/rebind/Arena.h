@@ -0,0 +1,148 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace rebind {
+
+/******************************************************************************/
+
+/// Per-thread bump allocator for the temporaries made while dispatching a call.
+/// Memory is released in stack order by rewinding to a Mark; blocks are kept for reuse,
+/// so once warmed up a thread's calls make no heap allocations for their temporaries.
+class Arena {
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        std::size_t size;
+    };
+
+    struct Destructor {
+        void (*destroy)(void *) noexcept;
+        void *ptr;
+        Destructor *next;
+    };
+
+    std::vector<Block> blocks;
+    std::size_t current = 0, offset = 0;
+    Destructor *destructors = nullptr;
+
+    static constexpr std::size_t initial_size = 4096;
+
+    template <class T>
+    static void destroy(void *p) noexcept {static_cast<T *>(p)->~T();}
+
+public:
+    /// Position in the arena which can be rewound to
+    struct Mark {
+        std::size_t block, offset;
+        Destructor *destructors;
+    };
+
+    /// Number of CallScopes active on this arena
+    unsigned int scopes = 0;
+
+    Arena() = default;
+    Arena(Arena const &) = delete;
+    Arena &operator=(Arena const &) = delete;
+    ~Arena() {rewind({0, 0, nullptr});}
+
+    /// The arena of the calling thread
+    static Arena &local() noexcept;
+
+    Mark mark() const noexcept {return {current, offset, destructors};}
+
+    /// Destroy everything made since the mark, in reverse order, and release its memory
+    void rewind(Mark const &m) noexcept {
+        while (destructors != m.destructors) {
+            destructors->destroy(destructors->ptr);
+            destructors = destructors->next;
+        }
+        current = m.block;
+        offset = m.offset;
+    }
+
+    void *allocate(std::size_t n, std::size_t align) {
+        for (;; ++current, offset = 0) {
+            if (current == blocks.size()) {
+                std::size_t size = blocks.empty() ? initial_size : 2 * blocks.back().size;
+                while (size < n + align) size *= 2;
+                blocks.push_back({std::make_unique<unsigned char[]>(size), size});
+            }
+            auto const base = reinterpret_cast<std::uintptr_t>(blocks[current].data.get());
+            auto const p = (base + offset + align - 1) & ~std::uintptr_t(align - 1);
+            if (p + n <= base + blocks[current].size) {
+                offset = p + n - base;
+                return reinterpret_cast<void *>(p);
+            }
+        }
+    }
+
+    /// Construct a T which lasts until the arena is rewound past it
+    template <class T, class ...Ts>
+    T *make(Ts &&...ts) {
+        void *p = allocate(sizeof(T), alignof(T));
+        T *t = ::new(p) T(static_cast<Ts &&>(ts)...);
+        if constexpr(!std::is_trivially_destructible_v<T>) {
+            Destructor *d = ::new(allocate(sizeof(Destructor), alignof(Destructor))) Destructor{destroy<T>, t, destructors};
+            destructors = d;
+        }
+        return t;
+    }
+
+    /// Copy a string into the arena
+    std::string_view copy(std::string_view s) {
+        if (s.empty()) return {};
+        auto p = static_cast<char *>(allocate(s.size(), 1));
+        std::memcpy(p, s.data(), s.size());
+        return {p, s.size()};
+    }
+};
+
+/******************************************************************************/
+
+/// Standard allocator drawing from an Arena. Deallocation is deferred until the arena is rewound
+template <class T>
+struct ArenaAllocator {
+    using value_type = T;
+    Arena *arena;
+
+    ArenaAllocator(Arena &a) noexcept : arena(&a) {}
+
+    template <class U>
+    ArenaAllocator(ArenaAllocator<U> const &a) noexcept : arena(a.arena) {}
+
+    T *allocate(std::size_t n) {return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));}
+    void deallocate(T *, std::size_t) noexcept {}
+
+    template <class U>
+    bool operator==(ArenaAllocator<U> const &a) const noexcept {return arena == a.arena;}
+    template <class U>
+    bool operator!=(ArenaAllocator<U> const &a) const noexcept {return arena != a.arena;}
+};
+
+/// Vector drawing from an Arena, e.g. for the temporaries of a call
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+/******************************************************************************/
+
+/// RAII scope of a top-level call: temporaries stored by any Dispatch on this thread
+/// while it is alive are destroyed when it ends, instead of with their Dispatch
+class CallScope {
+    Arena &arena;
+    Arena::Mark const start;
+public:
+    CallScope() noexcept : arena(Arena::local()), start(arena.mark()) {++arena.scopes;}
+    CallScope(CallScope const &) = delete;
+    CallScope &operator=(CallScope const &) = delete;
+    ~CallScope() {--arena.scopes; arena.rewind(start);}
+};
+
+/******************************************************************************/
+
+}
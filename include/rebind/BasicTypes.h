@@ -3,6 +3,12 @@
 #include "Conversions.h"
 #include <cstdlib>
 #include <cstdint>
+#include <array>
+#include <limits>
+
+#if __cplusplus > 201703L && __has_include(<span>)
+#   include <span>
+#endif
 
 namespace rebind {
 
@@ -90,21 +96,24 @@ class ArrayData {
     void *ptr;
     std::type_info const *t;
     bool mut;
+    bool swap = false;
 
 public:
     void const *pointer() const {return ptr;}
     bool mutate() const {return mut;}
+    /// Whether the elements are stored in non-native byte order (and so must be converted rather than viewed)
+    bool swapped() const {return swap;}
     std::type_info const &type() const {return t ? *t : typeid(void);}
 
-    ArrayData(void *p, std::type_info const *t, bool mut) : ptr(p), t(t), mut(mut) {}
+    ArrayData(void *p, std::type_info const *t, bool mut, bool swap=false) : ptr(p), t(t), mut(mut), swap(swap) {}
 
     template <class T>
     ArrayData(T *t) : ArrayData(const_cast<std::remove_cv_t<T> *>(static_cast<T const *>(t)),
-                                &typeid(std::remove_cv_t<T>), std::is_const_v<T>) {}
+                                &typeid(std::remove_cv_t<T>), !std::is_const_v<T>) {}
 
     template <class T>
     T * target() const {
-        if (!mut && !std::is_const<T>::value) return nullptr;
+        if (swap || (!mut && !std::is_const<T>::value)) return nullptr;
         if (type() != typeid(std::remove_cv_t<T>)) return nullptr;
         return static_cast<T *>(ptr);
     }
@@ -122,6 +131,328 @@ struct ArrayView {
     ArrayLayout layout;
 };
 
+/// Outcome of convert_array
+enum class ArrayConversion : unsigned char {
+    done,        //< all elements were converted
+    unsupported, //< either element type is not a builtin arithmetic type
+    inexact      //< an element is out of range for an integer type, or is a non-integer or NaN float
+};
+
+/// Convert the elements of an arithmetic array to type `to`, in row major order, into contiguous out.
+/// Handles any strides and byte order. Elements are never truncated or wrapped into an integer type
+/// (other than bool): out is left partly written if the conversion is inexact
+ArrayConversion convert_array(void *out, std::type_info const &to, ArrayData const &data, ArrayLayout const &layout);
+
+template <class T>
+ArrayConversion convert_array(T *out, ArrayView const &a) {return convert_array(out, typeid(T), a.data, a.layout);}
+
+/// Kind of an array element, as given by a buffer format code or a NumPy type string
+enum class ScalarKind : unsigned char {none, boolean, character, signed_integer, unsigned_integer, floating, complex, pointer, string};
+
+/// Fixed width C type of an element kind and size in bytes, or null if there is none
+std::type_info const *scalar_type(ScalarKind kind, std::size_t size) noexcept;
+
+/******************************************************************************/
+
+/// Call f(T &) on each element of a strided array, in row major order
+template <class T, class F>
+void for_each_strided(T *data, ArrayLayout const &layout, F &&f) {
+    std::size_t const n = layout.n_elem(), d = layout.depth();
+    if (!n) return;
+    if (d == 1) {
+        for (std::size_t i = 0; i != n; ++i) f(data[i * layout.stride(0)]);
+        return;
+    }
+    Vector<std::size_t> index(d, 0);
+    for (std::size_t e = 0; e != n; ++e) {
+        f(*data);
+        for (std::size_t i = d; i--;) { // odometer increment of the multi-index
+            data += layout.stride(i);
+            if (++index[i] != layout.shape(i)) break;
+            data -= layout.stride(i) * static_cast<std::ptrdiff_t>(index[i]);
+            index[i] = 0;
+        }
+    }
+}
+
+/// Non-owning view of contiguous elements of T, e.g. taken directly from a Python buffer
+template <class T>
+class Span {
+    T *m_data = nullptr;
+    std::size_t m_size = 0;
+
+public:
+    constexpr Span() noexcept = default;
+    constexpr Span(T *p, std::size_t n) noexcept : m_data(p), m_size(n) {}
+
+    constexpr T *data() const noexcept {return m_data;}
+    constexpr std::size_t size() const noexcept {return m_size;}
+    constexpr bool empty() const noexcept {return !m_size;}
+    constexpr T *begin() const noexcept {return m_data;}
+    constexpr T *end() const noexcept {return m_data + m_size;}
+    constexpr T &operator[](std::size_t i) const noexcept {return m_data[i];}
+};
+
+/// Read-only contiguous view of an arithmetic array as elements of T. Unlike Span<T const>, an array
+/// of another element type, byte order or strides is accepted: its elements are converted (see
+/// convert_array) into a temporary which lives until the end of the call
+template <class T>
+class ConvertedSpan : public Span<T const> {
+public:
+    using Span<T const>::Span;
+};
+
+/// Non-owning view of an N-dimensional array of T with arbitrary strides (in elements)
+template <class T>
+class StridedView {
+    T *m_data = nullptr;
+    ArrayLayout m_layout;
+
+public:
+    StridedView() = default;
+    StridedView(T *p, ArrayLayout l) noexcept : m_data(p), m_layout(std::move(l)) {}
+
+    T *data() const noexcept {return m_data;}
+    ArrayLayout const &layout() const noexcept {return m_layout;}
+    std::size_t depth() const noexcept {return m_layout.depth();}
+    std::size_t shape(std::size_t i) const {return m_layout.shape(i);}
+    std::ptrdiff_t stride(std::size_t i) const {return m_layout.stride(i);}
+    std::size_t size() const {return m_layout.n_elem();}
+    bool contiguous() const {return m_layout.row_major();}
+
+    /// Element at the given multi-index (one index per dimension)
+    template <class ...Is>
+    T &operator()(Is ...is) const {
+        std::ptrdiff_t offset = 0;
+        std::size_t i = 0;
+        ((offset += static_cast<std::ptrdiff_t>(is) * m_layout.stride(i++)), ...);
+        return m_data[offset];
+    }
+
+    /// Call f(T &) on each element in row major order
+    template <class F>
+    void for_each(F &&f) const {for_each_strided(m_data, m_layout, f);}
+};
+
+/// Typed view of an N-dimensional array with an inline layout of fixed rank. Strides are in elements
+template <class T, std::size_t N>
+class ArrayRef {
+    static_assert(N > 0, "ArrayRef must have at least one dimension");
+
+    T *m_data = nullptr;
+    std::array<std::size_t, N> m_shape{};
+    std::array<std::ptrdiff_t, N> m_stride{};
+
+public:
+    using value_type = T;
+    static constexpr std::size_t rank() noexcept {return N;}
+
+    constexpr ArrayRef() noexcept = default;
+
+    constexpr ArrayRef(T *p, std::array<std::size_t, N> const &shape, std::array<std::ptrdiff_t, N> const &stride) noexcept
+        : m_data(p), m_shape(shape), m_stride(stride) {}
+
+    /// Row major contiguous array of the given shape
+    constexpr ArrayRef(T *p, std::array<std::size_t, N> const &shape) noexcept : m_data(p), m_shape(shape) {
+        std::ptrdiff_t s = 1;
+        for (std::size_t i = N; i--;) {m_stride[i] = s; s *= m_shape[i];}
+    }
+
+    constexpr T *data() const noexcept {return m_data;}
+    constexpr std::size_t shape(std::size_t i) const noexcept {return m_shape[i];}
+    constexpr std::ptrdiff_t stride(std::size_t i) const noexcept {return m_stride[i];}
+    constexpr auto const &shape() const noexcept {return m_shape;}
+    constexpr auto const &stride() const noexcept {return m_stride;}
+
+    constexpr std::size_t size() const noexcept {
+        std::size_t n = 1;
+        for (auto s : m_shape) n *= s;
+        return n;
+    }
+
+    /// Whether elements are contiguous with the last index varying fastest (dimensions of length 1 are ignored)
+    constexpr bool is_row_major() const noexcept {
+        std::ptrdiff_t expected = 1;
+        for (std::size_t i = N; i--;) {
+            if (m_shape[i] < 2) continue;
+            if (m_stride[i] != expected) return false;
+            expected *= m_shape[i];
+        }
+        return true;
+    }
+
+    /// Whether elements are contiguous with the first index varying fastest (dimensions of length 1 are ignored)
+    constexpr bool is_column_major() const noexcept {
+        std::ptrdiff_t expected = 1;
+        for (std::size_t i = 0; i != N; ++i) {
+            if (m_shape[i] < 2) continue;
+            if (m_stride[i] != expected) return false;
+            expected *= m_shape[i];
+        }
+        return true;
+    }
+
+    constexpr bool is_contiguous() const noexcept {return is_row_major() || is_column_major();}
+
+    /// Pointer to size() contiguous elements (in either major order), or null if the array is strided
+    constexpr T *contiguous_data() const noexcept {return is_contiguous() ? m_data : nullptr;}
+
+    /// Element at the given multi-index
+    template <class ...Is>
+    constexpr T &operator()(Is ...is) const noexcept {
+        static_assert(sizeof...(Is) == N, "ArrayRef index must have one value per dimension");
+        std::ptrdiff_t offset = 0;
+        std::size_t i = 0;
+        ((offset += static_cast<std::ptrdiff_t>(is) * m_stride[i++]), ...);
+        return m_data[offset];
+    }
+
+    /// Element at the given multi-index
+    constexpr T &at(std::array<std::size_t, N> const &index) const noexcept {
+        std::ptrdiff_t offset = 0;
+        for (std::size_t i = 0; i != N; ++i) offset += static_cast<std::ptrdiff_t>(index[i]) * m_stride[i];
+        return m_data[offset];
+    }
+
+    /// Sub-array at index i of the first dimension, or the element itself if N is 1
+    constexpr decltype(auto) operator[](std::size_t i) const noexcept {
+        if constexpr(N == 1) return m_data[static_cast<std::ptrdiff_t>(i) * m_stride[0]];
+        else {
+            std::array<std::size_t, N - 1> shape;
+            std::array<std::ptrdiff_t, N - 1> stride;
+            for (std::size_t j = 1; j != N; ++j) {shape[j-1] = m_shape[j]; stride[j-1] = m_stride[j];}
+            return ArrayRef<T, N - 1>(m_data + static_cast<std::ptrdiff_t>(i) * m_stride[0], shape, stride);
+        }
+    }
+
+    /// Call f(T &) on each element in row major order, as a flat loop if the array is row major contiguous
+    template <class F>
+    void for_each(F &&f) const {
+        if (is_row_major()) {
+            for (T *p = m_data, *e = m_data + size(); p != e; ++p) f(*p);
+            return;
+        }
+        if (!size()) return;
+        std::array<std::size_t, N> index{};
+        T *p = m_data;
+        for (std::size_t n = size(); n--;) {
+            f(*p);
+            for (std::size_t i = N; i--;) {
+                p += m_stride[i];
+                if (++index[i] != m_shape[i]) break;
+                p -= m_stride[i] * static_cast<std::ptrdiff_t>(index[i]);
+                index[i] = 0;
+            }
+        }
+    }
+};
+
+/// Check that an ArrayView holds elements of exactly T (not byte swapped, and mutable if T is not const)
+template <class T, class V>
+T *array_target(ArrayView const &a, Dispatch &msg) {
+    if (auto p = a.data.target<T>()) return p;
+    if (a.data.swapped()) msg.error("array is not in native byte order", Type<V>());
+    else if (a.data.type() == typeid(std::remove_cv_t<T>)) msg.error("array is not writable", Type<V>());
+    else msg.error("array has the wrong element type", Type<V>());
+    return nullptr;
+}
+
+/// Zero-copy view of an array which is row major contiguous
+template <class T>
+struct Request<Span<T>> {
+    std::optional<Span<T>> operator()(Variable const &v, Dispatch &msg) const {
+        auto a = v.request<ArrayView>(msg);
+        if (!a) return msg.error("expected array", Type<Span<T>>());
+        if (!a->layout.row_major()) return msg.error("expected contiguous array", Type<Span<T>>());
+        if (auto p = array_target<T, Span<T>>(*a, msg)) return Span<T>(p, a->layout.n_elem());
+        return msg.error();
+    }
+};
+
+/// View of an array, converted into a temporary if it is not already contiguous elements of T
+template <class T>
+struct Request<ConvertedSpan<T>> {
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>, "ConvertedSpan requires an arithmetic type");
+
+    std::optional<ConvertedSpan<T>> operator()(Variable const &v, Dispatch &msg) const {
+        auto a = v.request<ArrayView>(msg);
+        if (!a) return msg.error("expected array", Type<ConvertedSpan<T>>());
+        std::size_t const n = a->layout.n_elem();
+        if (a->layout.row_major())
+            if (auto p = a->data.template target<T const>()) return ConvertedSpan<T>(p, n);
+        auto tmp = msg.store(Vector<T>(n));
+        switch (convert_array(tmp->data(), *a)) {
+            case ArrayConversion::done: return ConvertedSpan<T>(tmp->data(), n);
+            case ArrayConversion::inexact: return msg.error("array element is out of range or not an integer", Type<ConvertedSpan<T>>());
+            default: return msg.error("array has the wrong element type", Type<ConvertedSpan<T>>());
+        }
+    }
+};
+
+/// Zero-copy view of an array with any strides
+template <class T>
+struct Request<StridedView<T>> {
+    std::optional<StridedView<T>> operator()(Variable const &v, Dispatch &msg) const {
+        auto a = v.request<ArrayView>(msg);
+        if (!a) return msg.error("expected array", Type<StridedView<T>>());
+        if (auto p = array_target<T, StridedView<T>>(*a, msg)) return StridedView<T>(p, std::move(a->layout));
+        return msg.error();
+    }
+};
+
+/// Zero-copy typed view of an array of rank N
+template <class T, std::size_t N>
+struct Request<ArrayRef<T, N>> {
+    std::optional<ArrayRef<T, N>> operator()(Variable const &v, Dispatch &msg) const {
+        auto a = v.request<ArrayView>(msg);
+        if (!a) return msg.error("expected array", Type<ArrayRef<T, N>>());
+        if (a->layout.depth() != N)
+            return msg.error("array has the wrong number of dimensions", Type<ArrayRef<T, N>>(), N, a->layout.depth());
+        auto p = array_target<T, ArrayRef<T, N>>(*a, msg);
+        if (!p) return msg.error();
+        std::array<std::size_t, N> shape;
+        std::array<std::ptrdiff_t, N> stride;
+        for (std::size_t i = 0; i != N; ++i) {shape[i] = a->layout.shape(i); stride[i] = a->layout.stride(i);}
+        return ArrayRef<T, N>(p, shape, stride);
+    }
+};
+
+template <class T, std::size_t N>
+struct Response<ArrayRef<T, N>> {
+    bool operator()(Variable &out, TypeIndex const &t, ArrayRef<T, N> const &a) const {
+        if (t.equals<ArrayView>()) return out.emplace(Type<ArrayView>(), a.data(), ArrayLayout(a.shape(), a.stride())), true;
+        return false;
+    }
+};
+
+template <class T>
+struct Response<Span<T>> {
+    bool operator()(Variable &out, TypeIndex const &t, Span<T> const &s) const {
+        if (t.equals<ArrayView>()) return out.emplace(Type<ArrayView>(), s.data(), s.size()), true;
+        return false;
+    }
+};
+
+template <class T>
+struct Response<StridedView<T>> {
+    bool operator()(Variable &out, TypeIndex const &t, StridedView<T> const &s) const {
+        if (t.equals<ArrayView>()) return out.emplace(Type<ArrayView>(), s.data(), s.layout()), true;
+        return false;
+    }
+};
+
+#if __cplusplus > 201703L && __has_include(<span>)
+
+template <class T>
+struct Request<std::span<T>> {
+    std::optional<std::span<T>> operator()(Variable const &v, Dispatch &msg) const {
+        if (auto s = v.request<Span<T>>(msg)) return std::span<T>(s->data(), s->size());
+        return msg.error();
+    }
+};
+
+#endif
+
 /******************************************************************************/
 
 template <class T>
@@ -166,8 +497,20 @@ struct Request<char const *> {
 using BinaryType = std::byte;
 using Binary = std::vector<BinaryType>;
 
-// using BinaryView = std::basic_string_view<BinaryType>;
+/// Read-only view of bytes, e.g. of a Python bytes object or any other bytes-like object
+class BinaryView {
+    BinaryType const *m_begin=nullptr;
+    BinaryType const *m_end=nullptr;
+public:
+    constexpr BinaryView() = default;
+    constexpr BinaryView(BinaryType const *b, std::size_t n) : m_begin(b), m_end(b + n) {}
+    constexpr auto begin() const {return m_begin;}
+    constexpr auto data() const {return m_begin;}
+    constexpr auto end() const {return m_end;}
+    constexpr std::size_t size() const {return m_end - m_begin;}
+};
 
+/// Mutable view of bytes, e.g. of a Python bytearray or any other writable bytes-like object
 class BinaryData {
     BinaryType *m_begin=nullptr;
     BinaryType *m_end=nullptr;
@@ -178,36 +521,23 @@ public:
     constexpr auto data() const {return m_begin;}
     constexpr auto end() const {return m_end;}
     constexpr std::size_t size() const {return m_end - m_begin;}
-    // operator BinaryView() const {return {m_begin, size()};}
-};
-
-// template <>
-// struct Response<BinaryData> {
-//     bool operator()(Variable &out, TypeIndex const &t, BinaryData const &v) const {
-//         // if (t.equals<BinaryView>()) return out.emplace(Type<BinaryView>(), v.begin(), v.size()), true;
-//         return false;
-//     }
-// };
-
-// template <>
-// struct Response<BinaryView> {
-//     bool operator()(Variable &out, TypeIndex const &, BinaryView const &v) const {
-//         return false;
-//     }
-// };
-
-// template <>
-// struct Request<BinaryView> {
-//     std::optional<BinaryView> operator()(Variable const &v, Dispatch &msg) const {
-//         if (auto p = v.request<BinaryData>()) return BinaryView(p->data(), p->size());
-//         return msg.error("not convertible to binary view", typeid(BinaryView));
-//     }
-// };
+    constexpr operator BinaryView() const {return {m_begin, size()};}
+};
+
+template <>
+struct Request<BinaryView> {
+    std::optional<BinaryView> operator()(Variable const &v, Dispatch &msg) const {
+        if (auto p = v.target<Binary const &>()) return BinaryView(p->data(), p->size());
+        if (auto p = v.request<BinaryData>()) return BinaryView(*p);
+        return msg.error("not convertible to binary view", Type<BinaryView>());
+    }
+};
 
 template <>
 struct Request<BinaryData> {
     std::optional<BinaryData> operator()(Variable const &v, Dispatch &msg) const {
-        return msg.error("not convertible to binary data", typeid(BinaryData));
+        if (auto p = v.target<Binary &>()) return BinaryData(p->data(), p->size());
+        return msg.error("not convertible to binary data", Type<BinaryData>());
     }
 };
 
@@ -217,8 +547,8 @@ template <class T>
 struct Response<T, Value, std::enable_if_t<(std::is_integral_v<T>)>> {
     bool operator()(Variable &out, TypeIndex const &i, T t) const {
         DUMP("response from integer", typeid(T).name(), i.name());
-        if (+i == typeid(Integer)) return out = static_cast<Integer>(t), true;
-        if (+i == typeid(Real)) return out = static_cast<Real>(t), true;
+        if (+i == type_index<Integer>()) return out = static_cast<Integer>(t), true;
+        if (+i == type_index<Real>()) return out = static_cast<Real>(t), true;
         DUMP("no response from integer");
         return false;
     }
@@ -231,12 +561,16 @@ Default Response for floating point allows conversion to Real or Integer
 template <class T>
 struct Response<T, Value, std::enable_if_t<(std::is_floating_point_v<T>)>> {
     bool operator()(Variable &out, TypeIndex const &i, T t) const {
-        if (i == typeid(Real)) return out = static_cast<Real>(t), true;
-        if (i == typeid(Integer)) return out = static_cast<Integer>(t), true;
+        if (i == type_index<Real>()) return out = static_cast<Real>(t), true;
+        if (i == type_index<Integer>()) return out = static_cast<Integer>(t), true;
         return false;
     }
 };
 
+/// Arithmetic and enum responses only depend on the requested type
+template <class T>
+struct StableResponse<T, std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>>> : std::true_type {};
+
 /*
 Default Request for integer type tries to go through double precision
 long double is not expected to be a useful route (it's assumed there are not multiple floating types larger than Real)
@@ -246,7 +580,7 @@ struct Request<T, std::enable_if_t<std::is_floating_point_v<T>>> {
     std::optional<T> operator()(Variable const &v, Dispatch &msg) const {
         DUMP("convert to floating");
         if (!std::is_same_v<Real, T>) if (auto p = v.request<Real>()) return static_cast<T>(*p);
-        return msg.error("not convertible to floating point", typeid(T));
+        return msg.error("not convertible to floating point", Type<T>());
     }
 };
 
@@ -258,9 +592,17 @@ template <class T>
 struct Request<T, std::enable_if_t<std::is_integral_v<T>>> {
     std::optional<T> operator()(Variable const &v, Dispatch &msg) const {
         DUMP("trying convert to arithmetic", v.type(), typeid(T).name());
-        if (!std::is_same_v<Integer, T>) if (auto p = v.request<Integer>()) return static_cast<T>(*p);
+        if (!std::is_same_v<Integer, T>) if (auto p = v.request<Integer>()) {
+            if constexpr(std::is_same_v<T, bool>) return static_cast<T>(*p);
+            else if constexpr(std::is_signed_v<T>) {
+                if (*p >= std::numeric_limits<T>::min() && *p <= std::numeric_limits<T>::max()) return static_cast<T>(*p);
+            } else {
+                if (*p >= 0 && static_cast<std::make_unsigned_t<Integer>>(*p) <= std::numeric_limits<T>::max()) return static_cast<T>(*p);
+            }
+            return msg.error("integer out of range", Type<T>());
+        }
         DUMP("failed to convert to arithmetic", v.type(), typeid(T).name());
-        return msg.error("not convertible to integer", typeid(T));
+        return msg.error("not convertible to integer", Type<T>());
     }
 };
 
@@ -272,7 +614,7 @@ struct Request<T, std::enable_if_t<std::is_enum_v<T>>> {
     std::optional<T> operator()(Variable const &v, Dispatch &msg) const {
         DUMP("trying convert to enum", v.type(), typeid(T).name());
         if (auto p = v.request<std::underlying_type_t<T>>()) return static_cast<T>(*p);
-        return msg.error("not convertible to enum", typeid(T));
+        return msg.error("not convertible to enum", Type<T>());
     }
 };
 
@@ -282,9 +624,9 @@ Default Response for enum permits conversion to integer types
 template <class T>
 struct Response<T, Value, std::enable_if_t<(std::is_enum_v<T>)>> {
     bool operator()(Variable &out, TypeIndex const &i, T t) const {
-        if (i == typeid(std::underlying_type_t<T>))
+        if (i == type_index<std::underlying_type_t<T>>())
             return out = static_cast<std::underlying_type_t<T>>(t), true;
-        if (i == typeid(Integer))
+        if (i == type_index<Integer>())
             return out = static_cast<Integer>(t), true;
         return false;
     }
@@ -302,14 +644,15 @@ struct Request<std::basic_string<T, Traits, Alloc>> {
         if (!std::is_same_v<std::basic_string<T, Traits, Alloc>, std::basic_string<T, Traits>>)
             if (auto p = v.request<std::basic_string<T, Traits>>())
                 return std::move(*p);
-        return msg.error("not convertible to string", typeid(T));
+        return msg.error("not convertible to string", Type<T>());
     }
 };
 
 template <class T, class Traits>
 struct Request<std::basic_string_view<T, Traits>> {
     std::optional<std::basic_string_view<T, Traits>> operator()(Variable const &v, Dispatch &msg) const {
-        return msg.error("not convertible to string view", typeid(T));
+        if (auto p = v.target<std::basic_string<T, Traits> const &>()) return std::basic_string_view<T, Traits>(*p);
+        return msg.error("not convertible to string view", Type<T>());
     }
 };
 
@@ -347,15 +690,15 @@ struct CompiledSequenceResponse {
 
     bool operator()(Variable &out, TypeIndex const &t, V const &v) const {
         auto idx = std::make_index_sequence<std::tuple_size_v<V>>();
-        if (t == typeid(Sequence)) return out = sequence(v, idx), true;
-        if (t == typeid(Array)) return out = array(v, idx), true;
+        if (t == type_index<Sequence>()) return out = sequence(v, idx), true;
+        if (t == type_index<Array>()) return out = array(v, idx), true;
         return false;
     }
 
     bool operator()(Variable &out, TypeIndex const &t, V &&v) const {
         auto idx = std::make_index_sequence<std::tuple_size_v<V>>();
-        if (t == typeid(Sequence)) return out = sequence(std::move(v), idx), true;
-        if (t == typeid(Array)) return out = array(std::move(v), idx), true;
+        if (t == type_index<Sequence>()) return out = sequence(std::move(v), idx), true;
+        if (t == type_index<Array>()) return out = array(std::move(v), idx), true;
         return false;
     }
 };
@@ -363,6 +706,9 @@ struct CompiledSequenceResponse {
 template <class T>
 struct Response<T, Value, std::enable_if_t<std::tuple_size<T>::value >= 0>> : CompiledSequenceResponse<T> {};
 
+template <class T>
+struct StableResponse<T, std::enable_if_t<std::tuple_size<T>::value >= 0>> : std::true_type {};
+
 /******************************************************************************/
 
 template <class V>
@@ -385,7 +731,7 @@ struct CompiledSequenceRequest {
     static void request(std::optional<V> &out, S &&s, Dispatch &msg) {
         DUMP("trying CompiledSequenceRequest request");
         if (std::size(s) != std::tuple_size_v<V>) {
-            msg.error("wrong sequence length", typeid(V), std::tuple_size_v<V>, s.size());
+            msg.error("wrong sequence length", Type<V>(), std::tuple_size_v<V>, s.size());
         } else {
             msg.indices.emplace_back(0);
             request_each(out, std::move(s), msg, std::make_index_sequence<std::tuple_size_v<V>>());
@@ -408,7 +754,7 @@ struct CompiledSequenceRequest {
             request(out, std::move(*p), msg);
         } else {
             DUMP("trying CompiledSequenceRequest3", r.type().name());
-            msg.error("expected sequence to make compiled sequence", typeid(V));
+            msg.error("expected sequence to make compiled sequence", Type<V>());
         }
         return out;
     }
@@ -474,6 +820,9 @@ struct VectorResponse {
 template <class T, class A>
 struct Response<std::vector<T, A>, Value, std::enable_if_t<!std::is_same_v<T, Variable>>> : VectorResponse<std::vector<T, A>> {};
 
+template <class T, class A>
+struct StableResponse<std::vector<T, A>, std::enable_if_t<!std::is_same_v<T, Variable>>> : std::true_type {};
+
 /******************************************************************************/
 
 template <class V>
@@ -498,13 +847,23 @@ struct VectorRequest {
     std::optional<V> operator()(Variable const &v, Dispatch &msg) const {
         if (auto p = v.request<ArrayView>()) {
             if (auto t = p->data.target<T const>()) {
-                return V(t, t + p->layout.n_elem());
+                if (p->layout.row_major()) return V(t, t + p->layout.n_elem());
+                V out;
+                out.reserve(p->layout.n_elem());
+                for_each_strided(t, p->layout, [&](T const &x) {out.emplace_back(x);});
+                return out;
+            }
+            if constexpr(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+                V out(p->layout.n_elem());
+                auto const c = convert_array(out.data(), *p);
+                if (c == ArrayConversion::done) return out;
+                if (c == ArrayConversion::inexact) return msg.error("array element is out of range or not an integer", Type<V>());
             }
         }
         // if (auto p = v.request<Vector<T>>()) return get(*p, msg);
         if (!std::is_same_v<V, Sequence>)
             if (auto p = v.request<Sequence>()) return get(*p, msg);
-        return msg.error("expected sequence", typeid(V));
+        return msg.error("expected sequence", Type<V>());
     }
 };
 
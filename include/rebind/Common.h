@@ -5,6 +5,10 @@
 #include <iostream>
 #include <string_view>
 #include <memory>
+#include <utility>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 #ifdef NDEBUG
 #define DUMP(...) if (false) {}
@@ -82,38 +86,160 @@ Vector<T> mapped(V const &v, F &&f) {
 
 /******************************************************************************/
 
-/// Interface: return a new frame given a shared_ptr of *this
+struct Frame;
+
+/// Shared handle to a Frame held by escaped Callers. Users are counted so that the frame is
+/// only detached, and then destroyed, once no FrameLock is using it
+class FrameAnchor {
+    std::mutex mutex;
+    std::condition_variable released;
+    Frame *frame;
+    std::size_t users = 0;
+
+public:
+    explicit FrameAnchor(Frame *f) noexcept : frame(f) {}
+
+    /// The frame, which stays alive until release(), or null if it was detached
+    Frame *acquire() {
+        std::lock_guard<std::mutex> lk(mutex);
+        if (frame) ++users;
+        return frame;
+    }
+
+    void release() noexcept {
+        std::lock_guard<std::mutex> lk(mutex);
+        if (--users == 0) released.notify_all();
+    }
+
+    /// Wait for the current users, which may still nest acquisitions, then clear the frame
+    void detach() noexcept {
+        std::unique_lock<std::mutex> lk(mutex);
+        released.wait(lk, [&] {return users == 0;});
+        frame = nullptr;
+    }
+
+    bool attached() {
+        std::lock_guard<std::mutex> lk(mutex);
+        return frame;
+    }
+};
+
+/******************************************************************************/
+
+/// Interface of the context a call runs in, e.g. the state of the Python GIL.
+/// A Frame normally lives on the stack of the call; nested calls run in the same frame
 struct Frame {
-    virtual std::shared_ptr<Frame> operator()(std::shared_ptr<Frame> &&) = 0;
     virtual void enter() {};
-    virtual ~Frame() {};
+
+    /// Make the frame's runtime usable from the calling thread until unlock() is given the
+    /// returned token, e.g. by taking the Python GIL. Locks may nest and be taken from any thread
+    virtual int lock() {return 0;}
+    virtual void unlock(int) noexcept {}
+
+    /// Equivalent frame which may outlive the call and be used from any thread, or null if none
+    virtual std::shared_ptr<Frame> persist() {return nullptr;}
+
+    Frame() = default;
+    Frame(Frame const &) = delete;
+    Frame &operator=(Frame const &) = delete;
+
+    virtual ~Frame() {detach();}
+
+protected:
+    /// Wait until no escaped Caller is using the frame and make them all empty. A derived
+    /// frame should call this first in its destructor, while its overrides are still usable
+    void detach() noexcept {if (auto a = std::exchange(anchor, nullptr)) a->detach();}
+
+private:
+    friend class Caller;
+    /// Made only when a Caller escapes the call
+    std::shared_ptr<FrameAnchor> anchor;
 };
 
 /******************************************************************************/
 
+/// Handle to the Frame of a call. Within the call it is a plain pointer, so passing it around
+/// involves no allocation or atomics. A Caller which may outlive the call (e.g. in a Callback)
+/// should be made with escape(), after which its frame is only used under a FrameLock
 class Caller {
-    std::weak_ptr<Frame> model;
+    Frame *frame = nullptr;
+    std::shared_ptr<FrameAnchor> anchor;
+
 public:
     Caller() = default;
 
-    explicit operator bool() const {return !model.expired();}
+    Caller(Frame &f) noexcept : frame(&f) {}
 
-    Caller(std::shared_ptr<Frame> const &f): model(f) {}
+    explicit operator bool() const {return anchor ? anchor->attached() : bool(frame);}
 
-    void enter() {if (auto p = model.lock()) p->enter();}
+    /// Only used within the call, before the Caller may have escaped
+    void enter() {if (frame) frame->enter();}
 
-    std::shared_ptr<Frame> operator()() const {
-        if (auto p = model.lock()) return p.get()->operator()(std::move(p));
-        return {};
+    /// Caller which stays safe to hold after the call ends
+    Caller escape() const {
+        if (anchor || !frame) return *this;
+        if (!frame->anchor) frame->anchor = std::make_shared<FrameAnchor>(frame);
+        Caller out;
+        out.anchor = frame->anchor;
+        return out;
     }
 
-    template <class T>
-    T * target() {
-        if (auto p = model.lock()) return dynamic_cast<T *>(p.get());
-        return nullptr;
+    /// Caller which may be held indefinitely and used from any thread, or an empty one
+    /// if the frame cannot be persisted
+    Caller persist() const;
+
+    friend class FrameLock;
+};
+
+/******************************************************************************/
+
+/// RAII lock of the Frame of a Caller, if it has one (see Frame::lock()). For an escaped
+/// Caller, the frame is kept from being destroyed while the lock is held
+class FrameLock {
+    std::shared_ptr<FrameAnchor> anchor;
+    Frame *frame;
+    int token = 0;
+public:
+    explicit FrameLock(Caller const &c) : anchor(c.anchor), frame(anchor ? anchor->acquire() : c.frame) {
+        if (!frame) return;
+        try {token = frame->lock();}
+        catch (...) {if (anchor) anchor->release(); throw;}
+    }
+
+    FrameLock(FrameLock const &) = delete;
+    FrameLock &operator=(FrameLock const &) = delete;
+
+    ~FrameLock() {
+        if (!frame) return;
+        frame->unlock(token);
+        if (anchor) anchor->release();
     }
+
+    explicit operator bool() const {return frame;}
+
+    template <class T>
+    T * target() const {return dynamic_cast<T *>(frame);}
 };
 
 /******************************************************************************/
 
+inline Caller Caller::persist() const {
+    Frame *p = anchor ? anchor->acquire() : frame;
+    if (!p) return {};
+    std::shared_ptr<Frame> f;
+    try {f = p->persist();}
+    catch (...) {if (anchor) anchor->release(); throw;}
+    if (anchor) anchor->release();
+    if (!f) return {};
+    struct Persistent : FrameAnchor {
+        std::shared_ptr<Frame> owner;
+        Persistent(std::shared_ptr<Frame> f) : FrameAnchor(f.get()), owner(std::move(f)) {}
+    };
+    Caller out;
+    out.anchor = std::make_shared<Persistent>(std::move(f));
+    return out;
+}
+
+/******************************************************************************/
+
 }
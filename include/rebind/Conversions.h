@@ -85,6 +85,12 @@ using response_method = typename ResponseMethod<T>::type;
 
 /******************************************************************************/
 
+/// By default only the implicit conversions are known not to depend on the held value
+template <class T, class SFINAE>
+struct StableResponse : std::is_same<response_method<T>, Default> {};
+
+/******************************************************************************/
+
 template <class T, TargetQualifier Q>
 struct Response<T, Q, std::void_t<decltype(response(std::declval<TypeIndex>(), std::declval<T>()))>> {
     using method = ADL;
@@ -111,7 +117,7 @@ struct Request {
     using method = Default;
 
     std::optional<T> operator()(Variable const &r, Dispatch &msg) const {
-        return msg.error("mismatched class type", typeid(T));
+        return msg.error("mismatched class type", Type<T>());
     }
 };
 
@@ -121,7 +127,7 @@ struct Request<T &, SFINAE> {
     using method = Default;
 
     T * operator()(Variable const &v, Dispatch &msg) const {
-        lvalue_fails(v, msg, typeid(T));
+        lvalue_fails(v, msg, Type<T>());
         return nullptr;
     }
 };
@@ -136,7 +142,7 @@ struct Request<T const &, SFINAE> {
         if (auto p = v.request<T &>(msg)) return p;
         DUMP("trying temporary const & storage ", typeid(T).name());
         if (auto p = v.request<T>(msg)) return msg.store(std::move(*p));
-        return msg.error("could not bind to const lvalue reference", typeid(T)), nullptr;
+        return msg.error("could not bind to const lvalue reference", Type<T>()), nullptr;
     }
 };
 
@@ -148,7 +154,7 @@ struct Request<T &&, SFINAE> {
     T * operator()(Variable const &v, Dispatch &msg) const {
         DUMP("trying temporary && storage ", typeid(T).name());
         if (auto p = v.request<T>(msg)) return msg.store(std::move(*p));
-        rvalue_fails(v, msg, typeid(T));
+        rvalue_fails(v, msg, Type<T>());
         return nullptr;
     }
 };
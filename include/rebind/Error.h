@@ -1,5 +1,6 @@
 #pragma once
 #include "Signature.h"
+#include "Arena.h"
 
 #include <stdexcept>
 #include <string_view>
@@ -7,9 +8,8 @@
 #include <typeindex>
 #include <algorithm>
 #include <string>
-#include <any>
-#include <deque>
 #include <optional>
+#include <utility>
 
 namespace rebind {
 
@@ -54,20 +54,37 @@ struct WrongType : DispatchError {
 
 /******************************************************************************/
 
+/// Dispatch state of a conversion request. Its scope text, index stack and stored temporaries live
+/// in the thread's Arena until the enclosing CallScope ends. Without a CallScope they live in a private
+/// Arena destroyed with the Dispatch, so that nested requests cannot free each other's allocations.
 struct Dispatch {
-    std::string scope;
+private:
+    std::unique_ptr<Arena> own; //< private arena if there is no enclosing CallScope
+public:
+    Arena &arena;
+    std::string_view scope;
     Caller caller;
-    std::deque<std::any> storage; // deque is used so references don't go bad when doing emplace_back()
-    std::vector<unsigned int> indices;
-    std::string source;
+    ArenaVector<unsigned int> indices;
+    std::string_view source;
     TypeIndex dest;
     int index = -1, expected = -1, received = -1;
+    bool wrong_number = false; //< whether the error is the number of arguments rather than their types
+    bool stored = false; //< whether any temporaries have been stored
+
 
     std::nullopt_t error() noexcept {return std::nullopt;}
 
+    /// Set error information for the wrong number of arguments and return std::nullopt
+    std::nullopt_t error_number(int e, int r) noexcept {
+        wrong_number = true;
+        expected = e;
+        received = r;
+        return std::nullopt;
+    }
+
     /// Set error information and return std::nullopt for convenience
-    std::nullopt_t error(std::string msg) noexcept {
-        scope = std::move(msg);
+    std::nullopt_t error(std::string_view msg) {
+        scope = arena.copy(msg);
         return std::nullopt;
     }
 
@@ -78,26 +95,50 @@ struct Dispatch {
     }
 
     /// Set error information and return std::nullopt for convenience
-    std::nullopt_t error(std::string msg, TypeIndex d, int e=-1, int r=-1) noexcept {
-        scope = std::move(msg);
+    std::nullopt_t error(std::string_view msg, TypeIndex d, int e=-1, int r=-1) {
+        scope = arena.copy(msg);
         dest = std::move(d);
         expected = e;
         received = r;
         return std::nullopt;
     }
 
+    /// Set the description of the source of a failed conversion
+    void set_source(std::string_view s) {source = arena.copy(s);}
+
     /// Create exception from the current scopes and messages
-    WrongType exception() && noexcept {
-        return {std::move(scope), std::move(indices), std::move(source), std::move(dest), index, expected, received};
+    WrongType exception() && {
+        return {std::string(scope), {indices.begin(), indices.end()}, std::string(source), std::move(dest), index, expected, received};
+    }
+
+    /// Throw WrongNumber or WrongType from the current error
+    [[noreturn]] void raise() && {
+        if (wrong_number) throw WrongNumber(expected, received);
+        throw std::move(*this).exception();
     }
 
     /// Store a value which will last the lifetime of a conversion request. Return its address
     template <class T>
     unqualified<T> * store(T &&t) {
-        return std::addressof(storage.emplace_back().emplace<unqualified<T>>(static_cast<T &&>(t)));
+        stored = true;
+        return arena.make<unqualified<T>>(static_cast<T &&>(t));
     }
 
-    Dispatch(Caller c={}, char const *s="mismatched type") : scope(s), caller(std::move(c)) {indices.reserve(8);}
+    /// Whether stored temporaries will be destroyed with this Dispatch rather than at the end of a call
+    bool owns_temporaries() const noexcept {return stored && own;}
+
+    Dispatch(Caller c={}, char const *s="mismatched type")
+        : own(Arena::local().scopes ? nullptr : std::make_unique<Arena>()), arena(own ? *own : Arena::local()),
+          scope(s), caller(std::move(c)), indices(arena) {}
+
+    Dispatch(Dispatch &&m) noexcept
+        : own(std::move(m.own)), arena(m.arena), scope(m.scope), caller(std::move(m.caller)), indices(std::move(m.indices)),
+          source(m.source), dest(std::move(m.dest)), index(m.index), expected(m.expected), received(m.received),
+          wrong_number(m.wrong_number), stored(m.stored) {}
+
+    Dispatch(Dispatch const &) = delete;
+    Dispatch &operator=(Dispatch const &) = delete;
+    Dispatch &operator=(Dispatch &&) = delete;
 };
 
 /******************************************************************************/
@@ -4,13 +4,27 @@
 #include <typeindex>
 #include <iostream>
 #include <sstream>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <tuple>
 
 namespace rebind {
 
-using ErasedFunction = std::function<Variable(Caller, Sequence)>;
+/// Type erased overload. If the arguments do not match, it returns std::nullopt with the reason left
+/// in the Dispatch instead of throwing. The arguments are left intact then, but may be moved from otherwise
+using ErasedFunction = std::function<std::optional<Variable>(Caller, Sequence &, Dispatch &)>;
+
+/// Invoke an overload, throwing WrongNumber or WrongType if the arguments do not match
+inline Variable invoke(ErasedFunction const &f, Caller c, Sequence &args) {
+    CallScope scope;
+    Dispatch msg;
+    if (auto out = f(std::move(c), args, msg)) return std::move(*out);
+    std::move(msg).raise();
+}
 
 template <class R, class ...Ts>
-static TypeIndex const signature_types[] = {typeid(R), typeid(Ts)...};
+static TypeIndex const signature_types[] = {Type<unqualified<R>>(), Type<unqualified<Ts>>()...};
 
 /******************************************************************************/
 
@@ -39,13 +53,57 @@ public:
 
 /******************************************************************************/
 
+/// Identity and qualifier of the runtime type of each argument in a call
+using OverloadKey = ArenaVector<std::pair<void const *, Qualifier>>;
+
+/// Thread-safe map from the argument types of a call to the index of the overload which accepted them.
+/// Keys are looked up by hash and compared elementwise, so a lookup copies nothing to the heap
+class OverloadCache {
+    using Key = Vector<std::pair<void const *, Qualifier>>;
+    mutable std::shared_mutex mutex;
+    std::unordered_multimap<std::size_t, std::pair<Key, std::size_t>> indices;
+
+    static std::size_t hash(OverloadKey const &k) noexcept {
+        std::size_t out = k.size();
+        for (auto const &p : k)
+            out = (out << 5) ^ (out >> 2) ^ std::hash<void const *>()(p.first) ^ p.second;
+        return out;
+    }
+
+    std::size_t search(std::size_t h, OverloadKey const &k) const {
+        auto const range = indices.equal_range(h);
+        for (auto it = range.first; it != range.second; ++it)
+            if (std::equal(k.begin(), k.end(), it->second.first.begin(), it->second.first.end())) return it->second.second;
+        return npos;
+    }
+
+public:
+    static constexpr std::size_t npos = -1;
+
+    std::size_t find(OverloadKey const &k) const {
+        auto const h = hash(k);
+        std::shared_lock<std::shared_mutex> lk(mutex);
+        return search(h, k);
+    }
+
+    void emplace(OverloadKey const &k, std::size_t i) {
+        auto const h = hash(k);
+        std::unique_lock<std::shared_mutex> lk(mutex);
+        if (search(h, k) == npos) indices.emplace(h, std::make_pair(Key(k.begin(), k.end()), i));
+    }
+};
+
+/******************************************************************************/
+
 struct Function {
     Zip<ErasedSignature, ErasedFunction> overloads;
+    /// Resolved overloads, shared between copies and replaced whenever an overload is added
+    std::shared_ptr<OverloadCache> cache;
 
     Variable operator()(Caller c, Sequence v) const {
         DUMP("    - calling type erased Function ");
         if (overloads.empty()) return {}; //throw std::out_of_range("empty Function");
-        return overloads[0].second(std::move(c), std::move(v));
+        return invoke(overloads[0].second, std::move(c), v);
     }
 
     Function() = default;
@@ -73,6 +131,7 @@ struct Function {
 
     Function & emplace(ErasedFunction f, ErasedSignature const &s) & {
         overloads.emplace_back(s, std::move(f));
+        cache = std::make_shared<OverloadCache>();
         return *this;
     }
 
@@ -83,6 +142,7 @@ struct Function {
         auto fun = SimplifyFunction<F>()(std::move(f));
         constexpr std::size_t n = N == -1 ? 0 : SimpleSignature<decltype(fun)>::size - 1 - N;
         overloads.emplace_back(SimpleSignature<decltype(fun)>(), Adapter<n, decltype(fun)>{std::move(fun)});
+        cache = std::make_shared<OverloadCache>();
         return *this;
     }
 };
@@ -95,9 +155,10 @@ struct AnnotatedCallback {
     Caller caller;
 
     AnnotatedCallback() = default;
-    AnnotatedCallback(Function f, Caller c) : function(std::move(f)), caller(std::move(c)) {}
+    AnnotatedCallback(Function f, Caller const &c) : function(std::move(f)), caller(c.escape()) {}
 
     R operator()(Ts ...ts) const {
+        FrameLock lk(caller); // the result may need the frame's runtime to be converted
         Sequence pack;
         pack.reserve(sizeof...(Ts));
         (pack.emplace_back(static_cast<Ts &&>(ts)), ...);
@@ -111,10 +172,11 @@ struct Callback {
     Function function;
 
     Callback() = default;
-    Callback(Function f, Caller c) :  caller(std::move(c)), function(std::move(f)) {}
+    Callback(Function f, Caller const &c) : caller(c.escape()), function(std::move(f)) {}
 
     template <class ...Ts>
     R operator()(Ts &&...ts) const {
+        FrameLock lk(caller); // the result may need the frame's runtime to be converted
         Sequence pack;
         pack.reserve(sizeof...(Ts));
         (pack.emplace_back(static_cast<Ts &&>(ts)), ...);
@@ -122,6 +184,79 @@ struct Callback {
     }
 };
 
+/// Callback which stays valid after the call which made it, and may be invoked from any
+/// thread (e.g. from a C++ thread pool, taking the Python GIL for each invocation).
+/// Copies share the function, which is released by the last of them
+template <class R>
+struct PersistentCallback {
+    Caller caller;
+    std::shared_ptr<Function const> function;
+
+    PersistentCallback() = default;
+    PersistentCallback(Function f, Caller c) : caller(std::move(c)), function(std::make_shared<Function const>(std::move(f))) {}
+
+    explicit operator bool() const {return function && caller;}
+
+    /// Run f() with the frame locked, so that several invocations in f share one lock
+    template <class F>
+    decltype(auto) locked(F &&f) const {
+        FrameLock lk(caller);
+        return static_cast<F &&>(f)();
+    }
+
+    template <class ...Ts>
+    R operator()(Ts &&...ts) const {
+        if (!function) throw DispatchError("PersistentCallback is empty");
+        FrameLock lk(caller);
+        Sequence pack;
+        pack.reserve(sizeof...(Ts));
+        (pack.emplace_back(static_cast<Ts &&>(ts)), ...);
+        return (*function)(caller, std::move(pack)).cast(Type<R>());
+    }
+};
+
+/// Invocations of a PersistentCallback queued from any thread and run in batches, each
+/// batch under one lock of the frame. Invocations still pending on destruction are dropped
+template <class ...Ts>
+class CallbackQueue {
+    PersistentCallback<void> callback;
+    std::size_t batch;
+    std::mutex mutex;
+    std::vector<std::tuple<Ts...>> pending;
+
+public:
+    /// If batch is nonzero, push() flushes the queue once that many invocations are pending
+    explicit CallbackQueue(PersistentCallback<void> c, std::size_t batch=0) : callback(std::move(c)), batch(batch) {}
+
+    void push(Ts ...ts) {
+        std::unique_lock<std::mutex> lk(mutex);
+        pending.emplace_back(std::move(ts)...);
+        if (!batch || pending.size() < batch) return;
+        lk.unlock();
+        flush();
+    }
+
+    std::size_t size() {
+        std::lock_guard<std::mutex> lk(mutex);
+        return pending.size();
+    }
+
+    /// Run the pending invocations in order and return how many were run. If one throws,
+    /// the rest of its batch is dropped
+    std::size_t flush() {
+        return callback.locked([&] {
+            std::vector<std::tuple<Ts...>> work;
+            {
+                // taken under the frame lock so that batches run in the order they were taken
+                std::lock_guard<std::mutex> lk(mutex);
+                work.swap(pending);
+            }
+            for (auto &t : work) std::apply(callback, std::move(t));
+            return work.size();
+        });
+    }
+};
+
 /******************************************************************************/
 
 /// Cast element i of v to type T
@@ -210,18 +345,27 @@ Streamable<T> streamable(Type<T> t={}) {return {};}
 template <class R>
 struct Request<Callback<R>> {
     std::optional<Callback<R>> operator()(Variable const &v, Dispatch &msg) const {
-        if (!msg.caller) msg.error("Calling context expired", typeid(Callback<R>));
+        if (!msg.caller) msg.error("Calling context expired", Type<Callback<R>>());
         else if (auto p = v.request<Function>(msg)) return Callback<R>{std::move(*p), msg.caller};
         return {};
     }
 };
 
 
+template <class R>
+struct Request<PersistentCallback<R>> {
+    std::optional<PersistentCallback<R>> operator()(Variable const &v, Dispatch &msg) const {
+        if (auto c = msg.caller.persist(); !c) msg.error("Calling context cannot be persisted", Type<PersistentCallback<R>>());
+        else if (auto p = v.request<Function>(msg)) return PersistentCallback<R>{std::move(*p), std::move(c)};
+        return {};
+    }
+};
+
 template <class R, class ...Ts>
 struct Request<AnnotatedCallback<R, Ts...>> {
     using type = AnnotatedCallback<R, Ts...>;
     std::optional<type> operator()(Variable const &v, Dispatch &msg) const {
-        if (!msg.caller) msg.error("Calling context expired", typeid(type));
+        if (!msg.caller) msg.error("Calling context expired", Type<type>());
         else if (auto p = v.request<Function>(msg)) return type{std::move(*p), msg.caller};
         return {};
     }
@@ -0,0 +1,81 @@
+#pragma once
+#include "Document.h"
+#include <memory>
+
+namespace rebind {
+
+/******************************************************************************/
+
+/// Memory-mapped file, or a window of one. Copies share the same mapping, which is
+/// unmapped when the last of them is destroyed. The window is viewed as BinaryView (or
+/// BinaryData if writable), or as an ArrayView of a given element type and shape (by default 1D bytes)
+class MappedFile {
+    struct Mapping;
+    std::shared_ptr<Mapping const> m_map;
+    std::size_t m_offset = 0, m_size = 0;
+    std::type_info const *m_type = &typeid(unsigned char);
+    std::size_t m_itemsize = 1;
+    bool m_swap = false;
+    Vector<std::size_t> m_shape; //< empty for the default 1D shape
+
+public:
+    MappedFile() = default;
+
+    /// Map a whole file, read-only unless writable is set
+    explicit MappedFile(std::string const &path, bool writable=false);
+
+    bool has_value() const noexcept {return bool(m_map);}
+    bool writable() const noexcept;
+    BinaryType const *data() const noexcept;
+    std::size_t size() const noexcept {return m_size;}
+
+    /// Read-only view of the window's bytes
+    std::string_view bytes() const noexcept {return {reinterpret_cast<char const *>(data()), m_size};}
+
+    /// Mutable view of the window's bytes; throws if the mapping is read-only
+    BinaryData binary() const;
+
+    ArrayView array() const;
+
+    /// The same window viewed with a NumPy type string (e.g. "<f8", "i4", "|u1") and shape.
+    /// An empty shape means 1D over the whole window
+    MappedFile as_array(std::string_view dtype, Vector<std::size_t> shape={}) const;
+
+    /// Window of n bytes starting at offset, clipped to the end of this window
+    MappedFile window(std::size_t offset, std::size_t n) const;
+
+    /// Number of windows of n bytes covering this one
+    std::size_t chunk_count(std::size_t n) const noexcept {return n ? (m_size + n - 1) / n : 0;}
+
+    /// The i-th window of n bytes
+    MappedFile chunk(std::size_t i, std::size_t n) const {return window(i * n, n);}
+
+    /// All windows of n bytes in order, for out-of-core iteration
+    Vector<MappedFile> chunks(std::size_t n) const;
+
+    /// Pass an madvise hint for this window: "normal", "random", "sequential", "willneed" or "dontneed"
+    void advise(std::string_view hint) const;
+
+    /// Write changes in this window back to the file (no-op for a read-only mapping)
+    void flush() const;
+};
+
+/******************************************************************************/
+
+template <>
+struct Response<MappedFile> {
+    bool operator()(Variable &out, TypeIndex const &t, MappedFile const &f) const {
+        if (t.equals<BinaryData>()) return f.writable() && (out.emplace(Type<BinaryData>(), f.binary()), true);
+        if (t.equals<BinaryView>()) return out.emplace(Type<BinaryView>(), f.data(), f.size()), true;
+        if (t.equals<std::string_view>()) return out.emplace(Type<std::string_view>(), f.bytes()), true;
+        if (t.equals<ArrayView>()) return out.emplace(Type<ArrayView>(), f.array()), true;
+        return false;
+    }
+};
+
+/// Declares MappedFile in a Document; it is rendered into the default document()
+void render(Document &, Type<MappedFile>);
+
+/******************************************************************************/
+
+}
@@ -2,6 +2,8 @@
 #include "Common.h"
 #include "Error.h"
 
+#include <cstddef>
+
 namespace rebind {
 
 /******************************************************************************/
@@ -9,7 +11,23 @@ namespace rebind {
 struct Dispatch;
 struct VariableData;
 
-using Storage = std::aligned_storage_t<4 * sizeof(void*), std::alignment_of_v<void *>>;
+/// Inline capacity of a Variable. Types that fit (and are nothrow movable) are held without a heap allocation.
+/// Every translation unit linked together must agree on these, so set them through CMake rather than per file.
+#ifndef REBIND_STORAGE_SIZE
+#   define REBIND_STORAGE_SIZE (4 * sizeof(void *))
+#endif
+
+/// Alignment of the inline buffer of a Variable
+#ifndef REBIND_STORAGE_ALIGN
+#   define REBIND_STORAGE_ALIGN alignof(void *)
+#endif
+
+using Storage = std::aligned_storage_t<REBIND_STORAGE_SIZE, REBIND_STORAGE_ALIGN>;
+
+static_assert(sizeof(Storage) >= sizeof(void *) && alignof(Storage) >= alignof(void *),
+    "Variable storage must be able to hold a pointer");
+static_assert((REBIND_STORAGE_ALIGN & (REBIND_STORAGE_ALIGN - 1)) == 0,
+    "Variable storage alignment must be a power of 2");
 
 template <class T, class=void>
 struct UseStack : std::integral_constant<bool, (sizeof(T) <= sizeof(Storage))
@@ -20,24 +38,80 @@ struct UseStack : std::integral_constant<bool, (sizeof(T) <= sizeof(Storage))
 
 /******************************************************************************/
 
-enum class ActionType : std::uint_fast8_t {destroy, copy, move, response, assign};
-using ActionFunction = void(*)(ActionType, void *, VariableData *);
+/// Allocate n bytes (at fundamental alignment) for a Variable payload which does not fit in Storage.
+/// Small sizes are served by a pool with per-thread caches unless rebind was built with REBIND_POOL=0.
+void *allocate_payload(std::size_t n);
+
+/// Release memory from allocate_payload(n)
+void deallocate_payload(void *p, std::size_t n) noexcept;
+
+/// Counts of payload allocations since startup
+struct PoolStatistics {
+    std::size_t hits = 0;     //< allocations served from the calling thread's cache
+    std::size_t misses = 0;   //< allocations which had to refill a thread cache
+    std::size_t oversize = 0; //< allocations too large for the pool
+};
+
+/// Statistics flushed from all threads plus the calling thread's own counts (all zero if the pool is disabled)
+PoolStatistics pool_statistics() noexcept;
+
+/// Construct a heap-held Variable payload
+template <class T, class ...Ts>
+T *heap_new(Ts &&...ts) {
+    if constexpr(alignof(T) > alignof(std::max_align_t)) return ::new T{static_cast<Ts &&>(ts)...};
+    else {
+        void *p = allocate_payload(sizeof(T));
+        try {return ::new(p) T{static_cast<Ts &&>(ts)...};}
+        catch (...) {deallocate_payload(p, sizeof(T)); throw;}
+    }
+}
+
+/// Destroy a payload made by heap_new
+template <class T>
+void heap_delete(T *t) noexcept {
+    if constexpr(alignof(T) > alignof(std::max_align_t)) delete t;
+    else {
+        t->~T();
+        deallocate_payload(t, sizeof(T));
+    }
+}
+
+/******************************************************************************/
+
+/// Static per-type table of the operations on a held value. One instance (Action<T>::table) exists for each T
+struct ActionTable {
+    void (*destroy)(void *) noexcept;          //< delete the value stored at (void *)
+    void (*copy)(void const *, VariableData *); //< copy value from (void *) into empty (VariableData *)
+    void (*move)(void *, VariableData *) noexcept; //< move value from (void *) into empty (VariableData *), if held on the stack
+    void (*response)(void *, VariableData *);  //< convert existing value in (void *) to new value in (VariableData *)
+                                               //  using RequestData pre-stored in its buffer
+    void (*assign)(void *, VariableData *);    //< assign existing value at (void *) = existing value in (VariableData *)
+    bool trivially_copyable;
+    bool trivially_destructible;
+};
+
+using ActionFunction = ActionTable const *;
+
+/// Cached outcome of a Response from a held type to a target type
+enum class Route : std::uint_fast8_t {unknown, possible, impossible};
 
 struct RequestData {
     TypeIndex type;
     Dispatch *msg;
     Qualifier source;
+    Route route; //< cached route, so that the Response knows whether to record its outcome
 };
 
-static_assert(UseStack<RequestData>::value);
+static_assert(UseStack<RequestData>::value, "REBIND_STORAGE_SIZE is too small to hold a request");
 static_assert(std::is_trivially_destructible_v<RequestData>);
 
-// destroy: delete the value stored at (void *)
-// copy: copy value from (void *) into empty (Variable *)
-// move: move value from (void *) into empty (Variable *)
-// assign: assign existing value at (void *) = existing value in (Variable *)
-// response: convert existing value in (void *) to new value in (Variable *)
-//           using RequestData pre-stored in Variable->storage
+/******************************************************************************/
+
+/// Look up the cached Route from held type to target type given the source qualifier
+Route response_route(std::type_info const &held, TypeIndex const &target, Qualifier source);
+
+/// Record whether the Response from held type to target type succeeded
+void set_response_route(std::type_info const &held, TypeIndex const &target, Qualifier source, bool ok);
 
 /******************************************************************************/
 
@@ -46,7 +120,7 @@ static_assert(std::is_trivially_destructible_v<RequestData>);
 
 struct VariableData {
     Storage buff; //< Buffer holding either pointer to the object, or the object itself
-    ActionFunction act; //< Action<T>::apply of the held object, or NULL
+    ActionFunction act; //< Action<T>::table of the held object, or NULL
     TypeIndex idx; //< type and qualifier of the held object, or NULL
     bool stack; //< Whether the held type (non-reference) can fit in the buffer
 
@@ -76,6 +150,12 @@ struct VariableData {
         else return reinterpret_cast<void * const &>(buff);
     }
 
+    /// Destroy the held object if it is being managed. The call is skipped for trivially destructible objects on the stack
+    void destroy() noexcept {
+        if (auto p = handle())
+            if (!stack || !act->trivially_destructible) act->destroy(p);
+    }
+
     template <class T, std::enable_if_t<std::is_reference_v<T>, int> = 0>
     std::remove_reference_t<T> *target_pointer(Type<T> t, Qualifier q) const noexcept {
         // Qualifier is assumed not to be V
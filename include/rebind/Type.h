@@ -1,5 +1,6 @@
 #pragma once
 #include <utility>
+#include <cstdint>
 #include <typeindex>
 #include <string_view>
 #include <iostream>
@@ -66,60 +67,86 @@ void set_demangler(Demangler fun) noexcept;
 
 /******************************************************************************************/
 
+/// Return the dense id of a type, registering it on first use. Ids start at 1 and are shared
+/// by all shared objects in the process, since types are matched by std::type_index.
+/// This takes a lock unless the calling thread has already looked the type up, so prefer type_id<T>()
+std::uint32_t intern_type(std::type_info const &);
+
+/// Return the dense id of a type, cached per T
+template <class T>
+std::uint32_t type_id() {
+    static std::uint32_t const id = intern_type(typeid(T));
+    return id;
+}
+
+/******************************************************************************************/
+
 class TypeIndex {
-    std::pair<std::type_info const *, Qualifier> p;
-    constexpr TypeIndex(std::type_info const *t, Qualifier q=Value) noexcept : p(t, q) {}
+    std::type_info const *t = nullptr;
+    std::uint32_t id = 0; //< interned id of *t, or 0 if empty
+    Qualifier q = Value;
+
+    constexpr TypeIndex(std::type_info const *t0, std::uint32_t i, Qualifier q0) noexcept : t(t0), id(i), q(q0) {}
 
 public:
 
-    constexpr TypeIndex() noexcept : p(nullptr, Value) {};
-    constexpr TypeIndex(std::type_info const &t, Qualifier q=Value) noexcept : p(&t, q) {}
+    constexpr TypeIndex() noexcept = default;
+    /// Index of a runtime type, which is interned; TypeIndex(Type<T>()) is cheaper when T is known
+    TypeIndex(std::type_info const &t0, Qualifier q0=Value) : t(&t0), id(intern_type(t0)), q(q0) {}
 
     template <class T>
-    TypeIndex(Type<T>) noexcept : p(&typeid(T), qualifier_of<T>) {}
+    TypeIndex(Type<T>) : t(&typeid(T)), id(type_id<T>()), q(qualifier_of<T>) {}
 
     /**************************************************************************************/
 
-    std::type_info const & info() const noexcept {return p.first ? *p.first : typeid(void);}
+    std::type_info const & info() const noexcept {return t ? *t : typeid(void);}
     std::string name() const noexcept {return demangle(info().name());}
-    constexpr Qualifier qualifier() const noexcept {return p.second;}
+    constexpr Qualifier qualifier() const noexcept {return q;}
+
+    /// Interned id of the unqualified type, or 0 if empty
+    constexpr std::uint32_t index() const noexcept {return id;}
 
     explicit operator std::type_info const &() const noexcept {return info();}
     explicit operator std::type_index() const noexcept {return info();}
 
-    /// For now, hash code does not incorporate the qualifier
-    std::size_t hash_code() const noexcept {return info().hash_code();}
+    /// Perfect hash of the id and the qualifier
+    constexpr std::size_t hash_code() const noexcept {return static_cast<std::size_t>(id) << 2 | q;}
 
-    constexpr void set_qualifier(Qualifier q) noexcept {p.second = q;}
+    constexpr void set_qualifier(Qualifier q0) noexcept {q = q0;}
 
     /// Return if the index is not empty
-    constexpr explicit operator bool() const noexcept {return p.first;}
+    constexpr explicit operator bool() const noexcept {return id;}
 
     /// Test if this type equals another one, but ignoring all qualifiers
     template <class T>
-    bool matches(Type<T> t={}) const noexcept {return p.first && typeid(T) == *p.first;}
+    bool matches(Type<T> t={}) const {return id == type_id<T>();}
 
     /// Test if this type equals another one, but ignoring all qualifiers
-    bool matches(TypeIndex const &t) const noexcept {return p.first == t.p.first;}
+    constexpr bool matches(TypeIndex const &o) const noexcept {return id == o.id;}
 
     /// Test if this type equals a type specified as a compile time argument
     template <class T>
-    bool equals(Type<T> t={}) const noexcept {return p.first && typeid(T) == *p.first && qualifier_of<T> == p.second;}
+    bool equals(Type<T> t={}) const {return id == type_id<T>() && qualifier_of<T> == q;}
 
     /// Add a qualifier obeying the usual C++ semantics
-    constexpr TypeIndex add(Qualifier q) const noexcept {return {p.first, p.second == Value ? q : p.second};}
+    constexpr TypeIndex add(Qualifier q0) const noexcept {return {t, id, q == Value ? q0 : q};}
 
     /**************************************************************************************/
 
-    constexpr bool operator==(TypeIndex const &t) const {return p == t.p;}
-    constexpr bool operator!=(TypeIndex const &t) const {return p != t.p;}
-    constexpr bool operator<(TypeIndex const &t) const {return p < t.p;}
-    constexpr bool operator>(TypeIndex const &t) const {return p > t.p;}
-    constexpr bool operator<=(TypeIndex const &t) const {return p <= t.p;}
-    constexpr bool operator>=(TypeIndex const &t) const {return p >= t.p;}
+    constexpr bool operator==(TypeIndex const &o) const {return id == o.id && q == o.q;}
+    constexpr bool operator!=(TypeIndex const &o) const {return !(*this == o);}
+
+    /// Test if this is the unqualified type o, without interning o
+    bool operator==(std::type_info const &o) const noexcept {return t && q == Value && *t == o;}
+    bool operator!=(std::type_info const &o) const noexcept {return !(*this == o);}
+
+    constexpr bool operator<(TypeIndex const &o) const {return hash_code() < o.hash_code();}
+    constexpr bool operator>(TypeIndex const &o) const {return hash_code() > o.hash_code();}
+    constexpr bool operator<=(TypeIndex const &o) const {return hash_code() <= o.hash_code();}
+    constexpr bool operator>=(TypeIndex const &o) const {return hash_code() >= o.hash_code();}
 
     /// Return a copy without any qualifiers
-    constexpr TypeIndex operator+() const {return {p.first, Value};}
+    constexpr TypeIndex operator+() const {return {t, id, Value};}
 };
 
 
@@ -128,7 +155,7 @@ inline std::ostream & operator<<(std::ostream &os, TypeIndex t) {
 }
 
 template <class T>
-constexpr TypeIndex type_index(Type<T> t={}) {return t;}
+TypeIndex type_index(Type<T> t={}) {return t;}
 
 /******************************************************************************************/
 
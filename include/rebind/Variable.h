@@ -26,6 +26,9 @@ struct Response; // converts type T with qualifier Q into any qualified type
 template <class TargetType, class SFINAE=void>
 struct Request; // makes type T, a qualified type, from a Variable
 
+template <class SourceType, class SFINAE=void>
+struct StableResponse; // whether Response<T> depends only on the requested type (not on the held value)
+
 template <class T>
 struct Action;
 
@@ -37,8 +40,8 @@ class Variable : protected VariableData {
         {if (p) reinterpret_cast<void *&>(buff) = p;}
 
     Variable(Variable const &v, bool move) : VariableData(v) {
-        if (v.has_value())
-            act(move ? ActionType::move : ActionType::copy, v.pointer(), this);
+        if (v.has_value() && !(v.handle() && stack && act->trivially_copyable))
+            move ? act->move(v.pointer(), this) : act->copy(v.pointer(), this);
         idx.set_qualifier(Value);
     }
 
@@ -60,32 +63,32 @@ public:
     /// Reference type
     template <class T, std::enable_if_t<!(std::is_same_v<std::decay_t<T>, T>), int> = 0>
     Variable(Type<T> t, typename SameType<T>::type reference) noexcept
-        : VariableData(t, Action<std::decay_t<T>>::apply, UseStack<unqualified<T>>::value) {
+        : VariableData(t, &Action<std::decay_t<T>>::table, UseStack<unqualified<T>>::value) {
             reinterpret_cast<std::remove_reference_t<T> *&>(buff) = std::addressof(reference);
         }
 
     /// Non-Reference type
     template <class T, class ...Ts, std::enable_if_t<(std::is_same_v<std::decay_t<T>, T>), int> = 0>
-    Variable(Type<T> t, Ts &&...ts) : VariableData(t, Action<T>::apply, UseStack<T>::value) {
+    Variable(Type<T> t, Ts &&...ts) : VariableData(t, &Action<T>::table, UseStack<T>::value) {
         static_assert(!std::is_same_v<unqualified<T>, Variable>);
         if constexpr(UseStack<T>::value) ::new (&buff) T{static_cast<Ts &&>(ts)...};
-        else reinterpret_cast<T *&>(buff) = ::new T{static_cast<Ts &&>(ts)...};
+        else reinterpret_cast<T *&>(buff) = heap_new<T>(static_cast<Ts &&>(ts)...);
     }
 
     template <class T, std::enable_if_t<!(std::is_same_v<std::decay_t<T>, T>), int> = 0>
     std::remove_reference_t<T> *emplace(Type<T> t, typename SameType<T>::type reference) {
         using U = unqualified<T>;
-        if (auto p = handle()) act(ActionType::destroy, p, nullptr);
-        static_cast<VariableData &>(*this) = {t, Action<U>::apply, UseStack<U>::value};
+        destroy();
+        static_cast<VariableData &>(*this) = {t, &Action<U>::table, UseStack<U>::value};
         return reinterpret_cast<std::remove_reference_t<T> *&>(buff) = std::addressof(reference);
     }
 
     template <class T, class ...Ts, std::enable_if_t<(std::is_same_v<T, std::decay_t<T>>), int> = 0>
     T * emplace(Type<T> t, Ts &&...ts) {
-        if (auto p = handle()) act(ActionType::destroy, p, nullptr);
-        static_cast<VariableData &>(*this) = {t, Action<T>::apply, UseStack<T>::value};
+        destroy();
+        static_cast<VariableData &>(*this) = {t, &Action<T>::table, UseStack<T>::value};
         if constexpr(UseStack<T>::value) return ::new (&buff) T{static_cast<Ts &&>(ts)...};
-        else return reinterpret_cast<T *&>(buff) = ::new T{static_cast<Ts &&>(ts)...};
+        else return reinterpret_cast<T *&>(buff) = heap_new<T>(static_cast<Ts &&>(ts)...);
     }
 
     template <class T, std::enable_if_t<!std::is_base_of_v<VariableData, unqualified<T>>, int> = 0>
@@ -95,18 +98,19 @@ public:
 
     /// Take variables and reset the old ones
     // If RHS is Reference, RHS is left unchanged
-    // If RHS is Value and held in stack, RHS is moved from
+    // If RHS is Value and held in stack, RHS is moved from (trivially copyable values are just the copied bytes)
     // If RHS is Value and not held in stack, RHS is reset
     Variable(Variable &&v) noexcept : VariableData(static_cast<VariableData const &>(v)) {
         if (auto p = v.handle()) {
-            if (stack) act(ActionType::move, p, this);
-            else v.reset_data();
+            if (!stack) v.reset_data();
+            else if (!act->trivially_copyable) act->move(p, this);
         }
     }
 
-    /// Only call variable copy constructor if its lifetime is being managed
+    /// Only call variable copy constructor if its lifetime is being managed and it is not already copied bytewise
     Variable(Variable const &v) : VariableData(static_cast<VariableData const &>(v)) {
-        if (auto p = v.handle()) act(ActionType::copy, p, this);
+        if (auto p = v.handle())
+            if (!stack || !act->trivially_copyable) act->copy(p, this);
     }
 
     template <class T, std::enable_if_t<!std::is_base_of_v<VariableData, unqualified<T>>, int> = 0>
@@ -115,38 +119,32 @@ public:
     /// Only call variable move constructor if its lifetime is being managed inside the buffer
     Variable & operator=(Variable &&v) noexcept {
         // DUMP("move assign ", type(), v.type());
-        if (auto p = handle()) act(ActionType::destroy, p, nullptr);
+        destroy();
         static_cast<VariableData &>(*this) = v;
         if (auto p = v.handle()) {
-            if (stack) act(ActionType::move, p, this);
-            else v.reset_data();
+            if (!stack) v.reset_data();
+            else if (!act->trivially_copyable) act->move(p, this);
         }
         return *this;
     }
 
     Variable & operator=(Variable const &v) {
         // DUMP("copy assign ", type(), v.type());
-        if (auto p = handle()) act(ActionType::destroy, p, nullptr);
+        destroy();
         static_cast<VariableData &>(*this) = v;
-        if (auto p = v.handle()) v.act(ActionType::copy, p, this);
+        if (auto p = v.handle())
+            if (!stack || !act->trivially_copyable) act->copy(p, this);
         return *this;
     }
 
-    ~Variable() {
-        if (auto p = handle()) {
-            DUMP("Variable::~Variable() deallocate ", qualifier(), " from variable ", idx);
-            act(ActionType::destroy, p, nullptr);
-        } else {
-            DUMP("Variable::~Variable() not deleting ", qualifier(), " from variable ", idx);
-        }
-    }
+    ~Variable() {destroy();}
 
     /**************************************************************************/
 
     void reset() {
         // DUMP("reset", type());
 
-        if (auto p = handle()) act(ActionType::destroy, p, nullptr);
+        destroy();
         reset_data();
     }
 
@@ -178,8 +176,8 @@ public:
         DUMP("Variable.request() ", typeid(Type<T>).name(), qualifier(), " from variable ", idx);
         if (idx.matches<T>()) return target<T>();
         auto v = request_variable(msg, type_index<T>());
-        if (auto p = v.template target<T>()) {msg.source.clear(); return p;}
-        if (auto p = Request<T>()(*this, msg)) {msg.source.clear(); return p;}
+        if (auto p = v.template target<T>()) {msg.source = {}; return p;}
+        if (auto p = Request<T>()(*this, msg)) {msg.source = {}; return p;}
         return nullptr;
     }
 
@@ -193,9 +191,9 @@ public:
             if (auto p = target<T const &>()) out.emplace(*p);
         } 
 	if (!out) {
-            auto v = request_variable(msg, typeid(T));
-            if (auto p = std::move(v).target<T &&>()) {msg.source.clear(); out.emplace(std::move(*p));}
-            else if ((out = Request<T>()(*this, msg))) msg.source.clear();
+            auto v = request_variable(msg, type_index<T>());
+            if (auto p = std::move(v).template target<T &&>()) {msg.source = {}; out.emplace(std::move(*p));}
+            else if ((out = Request<T>()(*this, msg))) msg.source = {};
         }
         // DUMP(type(), p, &buff, reinterpret_cast<void * const &>(buff), stack, typeid(p).name(), typeid(Type<T>).name());
 
@@ -223,7 +221,7 @@ public:
     T cast(Type<T> t={}) const {
         Dispatch msg;
         if (auto p = request(msg, t))
-            return msg.storage.empty() ? static_cast<T>(*p) : throw std::runtime_error("contains temporaries");
+            return msg.owns_temporaries() ? throw std::runtime_error("contains temporaries") : static_cast<T>(*p);
         return cast(msg, t);
     }
 
@@ -299,53 +297,69 @@ template <class T>
 struct Action {
     static_assert(std::is_same_v<unqualified<T>, T>);
 
-    static void response(Variable &v, void *p, RequestData &&r) {
+    static void respond(Variable &v, void *p, RequestData &&r) {
         bool ok = false;
         Dispatch &msg = *r.msg; // r is aliasing v, so save a copy of the reference
-        if (r.source == Const)
-            ok = get_response(v, std::move(r.type), *static_cast<T const *>(p));
-        else if (r.source == Lvalue)
-            ok = get_response(v, std::move(r.type), *static_cast<T *>(p));
-        else if (r.source == Rvalue)
-            ok = get_response(v, std::move(r.type), static_cast<T &&>(*static_cast<T *>(p)));
+        TypeIndex const target = r.type;
+        Qualifier const source = r.source;
+        bool const record = StableResponse<T>::value && r.route == Route::unknown;
+        if (source == Const)
+            ok = get_response(v, target, *static_cast<T const *>(p));
+        else if (source == Lvalue)
+            ok = get_response(v, target, *static_cast<T *>(p));
+        else if (source == Rvalue)
+            ok = get_response(v, target, static_cast<T &&>(*static_cast<T *>(p)));
         else throw std::invalid_argument("source qualifier should not be Value");
+        // a failure which describes its source is not recorded, so that a cached failure
+        // reports the same source as this one
+        if (record && (ok || !v.has_value())) set_response_route(typeid(T), target, source, ok);
         if (!ok) {
             set_source(msg, typeid(T), std::move(v)); v.reset();
         }
     }
 
-    static void apply(ActionType a, void *p, VariableData *v) {
-        if (a == ActionType::destroy) { // Delete the object (known to be non-reference)
-            DUMP("delete ", typeid(T).name());
-            if constexpr(UseStack<T>::value) static_cast<T *>(p)->~T();
-            else delete static_cast<T *>(p);
-
-        } else if (a == ActionType::copy) { // Copy-Construct the object
-            DUMP(v->stack, UseStack<T>::value);
-            if constexpr(std::is_copy_constructible_v<T>) {
-                if constexpr(UseStack<T>::value) ::new(static_cast<void *>(&v->buff)) T{*static_cast<T const *>(p)};
-                else reinterpret_cast<void *&>(v->buff) = ::new T{*static_cast<T const *>(p)};
-            } else throw std::invalid_argument("not copyable");
-
-        } else if (a == ActionType::move) { // Move-Construct the object (known to be on stack)
-            DUMP(v->stack, UseStack<T>::value);
-            if constexpr(UseStack<T>::value) // this is always known, but eliminates compile warnings
-                ::new(static_cast<void *>(&v->buff)) T{std::move(*static_cast<T *>(p))};
-
-        } else if (a == ActionType::response) { // Respond to a given type_index
-            response(reinterpret_cast<Variable &>(*v), p, std::move(reinterpret_cast<RequestData &>(v->buff)));
-
-        } else if (a == ActionType::assign) { // Assign from another variable
-            // DUMP("assign", v->idx.name(), typeid(T).name(), v->qual);
-            if constexpr(!std::is_abstract_v<T> &&  std::is_move_assignable_v<T>) {
-                if (auto r = reinterpret_cast<Variable &&>(*v).request<T>()) {
-                    // DUMP("got the assignable", v->idx.name(), typeid(T).name(), v->qual, typeid(T).name());
-                    *static_cast<T *>(p) = std::move(*r);
-                    reinterpret_cast<Variable &>(*v).reset(); // signifies that assignment took place
-                }
+    /// Delete the object (known to be non-reference)
+    static void destroy(void *p) noexcept {
+        DUMP("delete ", typeid(T).name());
+        if constexpr(UseStack<T>::value) static_cast<T *>(p)->~T();
+        else heap_delete(static_cast<T *>(p));
+    }
+
+    /// Copy-Construct the object
+    static void copy(void const *p, VariableData *v) {
+        DUMP(v->stack, UseStack<T>::value);
+        if constexpr(std::is_copy_constructible_v<T>) {
+            if constexpr(UseStack<T>::value) ::new(static_cast<void *>(&v->buff)) T{*static_cast<T const *>(p)};
+            else reinterpret_cast<void *&>(v->buff) = heap_new<T>(*static_cast<T const *>(p));
+        } else throw std::invalid_argument("not copyable");
+    }
+
+    /// Move-Construct the object (known to be on stack)
+    static void move(void *p, VariableData *v) noexcept {
+        DUMP(v->stack, UseStack<T>::value);
+        if constexpr(UseStack<T>::value) // this is always known, but eliminates compile warnings
+            ::new(static_cast<void *>(&v->buff)) T{std::move(*static_cast<T *>(p))};
+    }
+
+    /// Respond to a given type_index
+    static void response(void *p, VariableData *v) {
+        respond(reinterpret_cast<Variable &>(*v), p, std::move(reinterpret_cast<RequestData &>(v->buff)));
+    }
+
+    /// Assign from another variable
+    static void assign(void *p, VariableData *v) {
+        // DUMP("assign", v->idx.name(), typeid(T).name(), v->qual);
+        if constexpr(!std::is_abstract_v<T> &&  std::is_move_assignable_v<T>) {
+            if (auto r = reinterpret_cast<Variable &&>(*v).request<T>()) {
+                // DUMP("got the assignable", v->idx.name(), typeid(T).name(), v->qual, typeid(T).name());
+                *static_cast<T *>(p) = std::move(*r);
+                reinterpret_cast<Variable &>(*v).reset(); // signifies that assignment took place
             }
         }
     }
+
+    static constexpr ActionTable table = {destroy, copy, move, response, assign,
+        std::is_trivially_copyable_v<T>, std::is_trivially_destructible_v<T>};
 };
 
 /******************************************************************************/
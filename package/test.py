@@ -1,15 +1,230 @@
-def g(x,y,z): pass
+'''
+Behaviour tests of the functions exported by source/Test.cc. Build the rebindtest
+target and run this with the build directory on PYTHONPATH (as ctest does).
+'''
+import array, atexit, ctypes, struct, sys
+import rebindtest
 
+atexit.register(rebindtest.document['clear_global_objects'])
 
-def f(*args):
-   print(*args)
+functions = dict(rebindtest.document['contents'])
 
+def call(name, *args, **kwargs):
+    return functions[name](*args, **kwargs)
 
-import functools
+def raises(error, name, *args, **kwargs):
+    '''Call the function, check that it raises error and return the message'''
+    try:
+        call(name, *args, **kwargs)
+    except error as e:
+        return str(e)
+    raise AssertionError('{} did not raise {}'.format(name, error.__name__))
 
-sig = inspect.signature(g)
+################################################################################
 
-def run(*args, _orig=f, _bind=sig.bind, **kwargs):
-    return _orig(*_bind(*args, **kwargs).args)
+def test_overload_order():
+    # the chosen overload must not depend on which overloads earlier calls chose
+    for _ in range(3):
+        assert call('pick', 1.5).cast(str) == 'double'
+        assert call('pick', 2.0).cast(str) == 'int'
+        assert call('pick', 3).cast(str) == 'int'
+        assert call('pick', 'x').cast(str) == 'string'
+    assert call('pick', 1.5, signature=1).cast(str) == 'double'
 
-functools.update_wrapper(run, g)
\ No newline at end of file
+def test_nested_dispatch():
+    assert call('nested_dispatch', 1000).cast(bool)
+
+################################################################################
+
+def doubles(*values):
+    return array.array('d', values)
+
+def matrix(rows, cols):
+    '''Row major rows x cols memoryview of doubles 0, 1, 2, ...'''
+    return memoryview(doubles(*range(rows * cols))).cast('B').cast('d', [rows, cols])
+
+def test_span():
+    assert call('span_sum', doubles(1, 2, 3)).cast(float) == 6
+    assert 'wrong element type' in raises(TypeError, 'span_sum', array.array('f', [1, 2, 3]))
+    assert 'contiguous' in raises(TypeError, 'span_sum', memoryview(doubles(1, 2, 3, 4))[::2])
+    ints = array.array('i', [1, 2, 3])
+    call('span_fill', ints)
+    assert list(ints) == [7, 7, 7]
+    assert 'not writable' in raises(TypeError, 'span_fill', memoryview(array.array('i', [1])).toreadonly())
+    if 'std_span_sum' in functions:
+        assert call('std_span_sum', doubles(1, 2)).cast(float) == 3
+
+def test_strided_view():
+    x = memoryview(doubles(1, 2, 3, 4, 5))
+    assert call('strided_sum', x[::2]).cast(float) == 9
+    assert call('strided_sum', x[::-1]).cast(float) == 15
+    m = matrix(2, 3)
+    assert call('strided_at', m, 1, 0).cast(float) == 3
+    assert call('strided_sum', m).cast(float) == 15
+
+def test_array_ref():
+    m = matrix(2, 3)
+    assert call('matrix_sum', m).cast(float) == 15
+    assert call('matrix_at', m, 1, 2).cast(float) == 5
+    assert call('matrix_row_major', m).cast(bool)
+    assert 'number of dimensions' in raises(TypeError, 'matrix_sum', doubles(1, 2))
+    assert 'wrong element type' in raises(TypeError, 'matrix_sum', memoryview(array.array('i', range(6))).cast('B').cast('i', [2, 3]))
+
+def test_converted_arrays():
+    assert call('converted_sum', doubles(1, 2, 3)).cast(float) == 6
+    assert call('converted_sum', array.array('f', [1, 2.5])).cast(float) == 3.5
+    assert call('converted_sum', array.array('h', [1, -2])).cast(float) == -1
+    assert call('converted_sum', memoryview(doubles(1, 2, 3, 4))[::-2]).cast(float) == 6
+    assert call('converted_sum', matrix(2, 2)).cast(float) == 6
+    swapped = (ctypes.c_double.__ctype_be__ if sys.byteorder == 'little' else ctypes.c_double.__ctype_le__) * 2
+    assert call('converted_sum', swapped(1, 2)).cast(float) == 3
+    assert 'byte order' in raises(TypeError, 'span_sum', swapped(1, 2))
+    for name in ('converted_ints', 'int_vector'):
+        assert call(name, doubles(1, -2)).cast(memoryview).tolist() == [1, -2]
+        assert call(name, array.array('q', [2**31 - 1])).cast(memoryview).tolist() == [2**31 - 1]
+        for bad in (doubles(1.5), doubles(float('nan')), doubles(float('inf')), doubles(2.0**31), array.array('q', [2**40])):
+            assert 'out of range or not an integer' in raises(TypeError, name, bad)
+
+def test_list_conversion():
+    values = lambda name, x: call(name, x).cast(memoryview).tolist()
+    assert values('int_vector', [1, -2, True, 3.0]) == [1, -2, 1, 3]
+    assert values('unsigned_vector', [0, 2**32 - 1]) == [0, 2**32 - 1]
+    assert values('double_vector', [1, 2.5, False]) == [1, 2.5, 0]
+    assert call('string_vector', ['a', b'b', 'c']).cast(str) == 'abc'
+    for bad in ([2**40], [2**70], [1.5], [float('nan')], [float('inf')], [1, 'x']):
+        raises(TypeError, 'int_vector', bad)
+    raises(TypeError, 'unsigned_vector', [-1])
+    raises(TypeError, 'unsigned_vector', [2**32])
+    raises(TypeError, 'double_vector', [10**400])
+
+def from_interface(obj):
+    '''Elements of a 1D double array read the way NumPy reads __array_interface__'''
+    face = obj.__array_interface__
+    assert face['typestr'][1:] == 'f8' and face['version'] == 3
+    data = bytes((ctypes.c_char * len(memoryview(face['data']).cast('B'))).from_buffer_copy(face['data'])) # a PyBUF_SIMPLE request
+    return [struct.unpack_from('d', data, face['offset'] + i * face['strides'][0])[0] for i in range(face['shape'][0])]
+
+def test_variable_buffer():
+    v = call('vec', 1.0, 2.0)
+    assert memoryview(v).tolist() == [1, 1, 2]
+    assert from_interface(v) == [1, 1, 2]
+    for reverse, expected in ((False, [0, 2, 4]), (True, [5, 3, 1])):
+        s = call('every_other', reverse)
+        assert memoryview(s).tolist() == expected
+        assert from_interface(s) == expected
+
+def test_exported_variable_is_not_assigned():
+    v = call('vec', 1.0, 2.0)
+    view = memoryview(v)
+    for method in (v.copy_from, v.move_from):
+        try:
+            method(call('vec', 3.0, 4.0))
+        except Exception:
+            pass
+        else:
+            raise AssertionError('assigned to an exported Variable')
+    face = v.__array_interface__
+    del view
+    try:
+        v.copy_from(call('vec', 3.0, 4.0))
+    except Exception:
+        pass
+    else:
+        raise AssertionError('assigned to a Variable exported through __array_interface__')
+    del face
+    v.copy_from(call('vec', 3.0, 4.0))
+    assert memoryview(v).tolist() == [3, 3, 4]
+    source = call('vec', 5.0, 6.0)
+    view = memoryview(source)
+    try:
+        v.move_from(source)
+    except Exception:
+        pass
+    else:
+        raise AssertionError('moved out of an exported Variable')
+    assert view.tolist() == [5, 5, 6]
+
+def test_binary():
+    for readable in (b'abc', bytearray(b'abc'), memoryview(b'abc'), memoryview(bytearray(b'abc')).toreadonly()):
+        assert call('binary_sum', readable).cast(int) == 294
+        assert call('binary_sum', readable, gil=False).cast(int) == 294
+    assert call('binary_sum', array.array('B', [1, 2])).cast(int) == 3
+    raises(TypeError, 'binary_sum', memoryview(b'abcd')[::2])
+    data = bytearray(3)
+    call('binary_fill', data)
+    assert data == bytearray(b'\x07\x07\x07')
+    for immutable in (b'abc', memoryview(bytearray(2)).toreadonly()):
+        raises(TypeError, 'binary_fill', immutable)
+
+def test_pinned_buffers():
+    for gil in (True, False):
+        x = doubles(1, 2)
+        def resize():
+            try:
+                x.append(3)
+            except BufferError:
+                pass
+            else:
+                raise AssertionError('array was resized during the call')
+        assert call('span_sum_after', x, resize, gil=gil).cast(float) == 3
+        x.append(3) # released once the call returns
+        ints = array.array('i', [1])
+        call('span_fill', ints, gil=gil)
+        ints.append(1)
+        assert list(ints) == [7, 1]
+        data = bytearray(2)
+        call('binary_fill', data, gil=gil)
+        data.extend(b'x')
+        assert data == bytearray(b'\x07\x07x')
+
+def test_escaped_callbacks():
+    assert call('keep', lambda x: x.cast(float) + 1).cast(float) == 2
+    assert 'expired' in raises(Exception, 'call_kept')
+    assert call('callback_from_thread', lambda x: x.cast(float) * 2, gil=False).cast(float) == 6
+    assert 'gil=False' in raises(Exception, 'callback_from_thread', lambda x: x)
+
+def test_persistent_callbacks():
+    call('persist', lambda x: 2 * x.cast(float))
+    assert call('run_persistent', 8, gil=False).cast(float) == 56
+    def fail(x):
+        raise ValueError('failed')
+    call('persist', fail)
+    raises(Exception, 'run_persistent', 2, gil=False)
+    call('release_persistent', gil=False)
+    raises(Exception, 'run_persistent', 1, gil=False)
+
+def test_callback_queue():
+    got = []
+    rest = call('queue_from_threads', lambda t, s: got.append((t.cast(int), int(s.cast(str)))), 100, 16, gil=False).cast(int)
+    assert rest < 16 and len(got) == 400
+    for t in range(4): # each thread's invocations stay in order
+        assert [i for k, i in got if k == t] == list(range(100))
+
+################################################################################
+
+def test_responses():
+    # the response compares the requested TypeIndex with a std::type_info
+    blah = dict(functions['submodule.Blah'][0])['new']('name')
+    assert blah.cast(str) == 'name'
+    raises(TypeError, 'span_sum', blah)
+
+################################################################################
+
+def test_registry():
+    document = rebindtest.document
+    new = dict(functions['Goo'][0])['new']
+    class Goo(document['Variable']):
+        pass
+    document['set_type'](new(1.0).type(), Goo)
+    # lookups see the current map while earlier ones are superseded by later registrations
+    for i in range(32):
+        document['set_output_conversion'](type('T{}'.format(i), (), {}), str)
+        assert type(new(float(i))) is Goo
+
+################################################################################
+
+if __name__ == '__main__':
+    for name, test in list(globals().items()):
+        if name.startswith('test_'):
+            test()
+            print('passed', name)
@@ -10,6 +10,8 @@ class Config:
     def __init__(self, methods):
         self._set_debug = methods['set_debug']
         self._get_debug = methods['debug']
+        self._set_zero_copy_bytes = methods['set_zero_copy_bytes']
+        self._get_zero_copy_bytes = methods['zero_copy_bytes']
         self.set_type_error = methods['set_type_error']
         self.set_type_names = methods['set_type_names']
         self.set_type = methods['set_type']
@@ -25,6 +27,14 @@ class Config:
     def debug(self, value):
         self._set_debug(bool(value))
 
+    @property
+    def zero_copy_bytes(self):
+        return self._get_zero_copy_bytes().cast(bool)
+
+    @zero_copy_bytes.setter
+    def zero_copy_bytes(self, value):
+        self._set_zero_copy_bytes(bool(value))
+
 ################################################################################
 
 from .render import render_module, render_init, render_member, \
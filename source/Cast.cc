@@ -101,7 +101,7 @@ Object variable_cast(Variable &&v, Object const &t) {
     PyObject *x;
     if (t) x = +t;
     else if (!v.has_value()) return {Py_None, true};
-    else if (auto it = python_types.find(v.type().info()); it != python_types.end()) x = +it->second;
+    else if (auto registered = python_types.find(+v.type())) x = +*registered;
     else x = type_object<Variable>();
 
     auto o = Object::from((x == type_object<Variable>()) ?
@@ -145,9 +145,14 @@ Object str_cast(Variable &&ref) {
     return {};
 }
 
-Object bytes_cast(Variable &&ref) {
+Object memoryview_cast(Variable &&ref, Object const &root);
+
+Object bytes_cast(Variable &&ref, Object const &root) {
+    if (ZeroCopyBytes)
+        if (auto o = memoryview_cast(std::move(ref), root)) return o;
     if (auto p = ref.request<BinaryData>()) return as_object(std::move(*p));
     if (auto p = ref.request<Binary>()) return as_object(std::move(*p));
+    if (auto p = ref.request<BinaryView>()) return as_object(std::move(*p));
     return {};
 }
 
@@ -161,13 +166,38 @@ Object function_cast(Variable &&ref) {
     else return {};
 }
 
+/// Read-only view of the bytes of a binary or string value
+std::optional<ArrayView> byte_view(Variable const &v) {
+    auto view = [](auto const *p, std::size_t n) {
+        return ArrayView{reinterpret_cast<unsigned char const *>(p), ArrayLayout(n)};
+    };
+    if (auto p = v.target<Binary const &>()) return view(p->data(), p->size());
+    if (auto p = v.request<BinaryView>()) return view(p->data(), p->size());
+    if (auto p = v.request<std::string_view>()) return view(p->data(), p->size());
+    return {};
+}
+
 Object memoryview_cast(Variable &&ref, Object const &root) {
-    if (auto p = ref.request<ArrayView>()) {
-        auto x = type_object<ArrayBuffer>();
-        auto obj = Object::from(PyObject_CallObject(x, nullptr));
-        cast_object<ArrayBuffer>(obj) = {std::move(*p), root};
-        return Object::from(PyMemoryView_FromObject(obj));
-    } else return {};
+    auto obj = Object::from(PyObject_CallObject(type_object<ArrayBuffer>(), nullptr));
+    if (!obj) return {};
+    auto &buff = cast_object<ArrayBuffer>(obj);
+    // A temporary (a value not held by root itself) is moved into the buffer first, since its data may live inline
+    bool const own = ref.qualifier() == Value && (!root || cast_if<Variable>(+root) != &ref);
+    if (own) buff.owner = std::move(ref);
+    Variable const &source = own ? buff.owner : ref;
+    // An owned value is viewed through an lvalue, so the view is writable where its type's response
+    // gives mutable data (e.g. std::vector<T>) and read-only where it does not (e.g. Span<T const>)
+    if (auto p = own ? buff.owner.reference().request<ArrayView>() : ref.request<ArrayView>()) {
+        buff.view(*p);
+    } else if (auto p = byte_view(source)) {
+        // Binary and string data is always exported read-only, since it may belong to an immutable object
+        buff.view(*p);
+    } else {
+        if (own) ref = std::move(buff.owner);
+        return {};
+    }
+    buff.base = root;
+    return Object::from(PyMemoryView_FromObject(obj));
 }
 
 Object getattr(PyObject *obj, char const *name) {
@@ -217,9 +247,13 @@ Object union_cast(Variable &&v, Object const &t, Object const &root) {
 // Then, the output_conversions map is queried for Python function callable with the Variable
 Object try_python_cast(Variable &&v, Object const &t, Object const &root) {
     DUMP("try_python_cast ", v.type());
-    if (auto it = type_translations.find(t); it != type_translations.end()) {
+    TypeConverters conv;
+    if (PyType_Check(+t)) conv = type_converters(reinterpret_cast<PyTypeObject *>(+t));
+    else if (auto p = type_translations.find(t)) conv.translation = *p;
+
+    if (conv.translation) {
         DUMP("type_translation found");
-        return try_python_cast(std::move(v), it->second, root);
+        return try_python_cast(std::move(v), conv.translation, root);
     } else if (PyType_CheckExact(+t)) {
         auto type = reinterpret_cast<PyTypeObject *>(+t);
         DUMP("is Variable ", is_subclass(type, type_object<Variable>()));
@@ -228,7 +262,7 @@ Object try_python_cast(Variable &&v, Object const &t, Object const &root) {
         else if (type == &PyLong_Type)                        return int_cast(std::move(v));                 // int
         else if (type == &PyFloat_Type)                       return float_cast(std::move(v));               // float
         else if (type == &PyUnicode_Type)                     return str_cast(std::move(v));                 // str
-        else if (type == &PyBytes_Type)                       return bytes_cast(std::move(v));               // bytes
+        else if (type == &PyBytes_Type)                       return bytes_cast(std::move(v), root);         // bytes
         else if (type == &PyBaseObject_Type)                  return as_deduced_object(std::move(v));        // object
         else if (is_subclass(type, type_object<Variable>()))  return variable_cast(std::move(v), t);         // Variable
         else if (type == type_object<TypeIndex>())            return type_index_cast(std::move(v));          // type(TypeIndex)
@@ -251,15 +285,17 @@ Object try_python_cast(Variable &&v, Object const &t, Object const &root) {
         DUMP("Not one of the structure types");
     }
 
-    DUMP("custom convert ", output_conversions.size());
-    if (auto p = output_conversions.find(t); p != output_conversions.end()) {
+    DUMP("custom convert ", output_conversions.snapshot().size());
+    if (!PyType_Check(+t))
+        if (auto p = output_conversions.find(t)) conv.output = *p;
+    if (conv.output) {
         DUMP(" conversion ");
         Object o = variable_cast(std::move(v));
         if (!o) return type_error("could not cast Variable to Python object");
         DUMP("calling function");
         auto &obj = static_cast<Var &>(cast_object<Variable>(o)).ward;
         if (!obj) obj = root;
-        return Object::from(PyObject_CallFunctionObjArgs(+p->second, +o, nullptr));
+        return Object::from(PyObject_CallFunctionObjArgs(+conv.output, +o, nullptr));
     }
 
     return nullptr;
@@ -2,28 +2,78 @@ namespace rebind {
 
 /******************************************************************************/
 
-Object call_overload(ErasedFunction const &fun, Sequence args, bool gil) {
+/// Call an overload. If the arguments do not match, return false with the reason left in msg
+bool call_overload(Object &out, ErasedFunction const &fun, Sequence &args, bool gil, Dispatch &msg) {
     // if (auto py = fun.target<PythonFunction>())
     //     return {PyObject_CallObject(+py->function, +args), false};
     DUMP("constructed python args ", args.size());
     for (auto const &p : args) DUMP(p.type());
-    Variable out;
+    std::optional<Variable> v;
     {
-        auto lk = std::make_shared<PythonFrame>(!gil);
-        Caller ct(lk);
+        PythonFrame frame(!gil); // restores the GIL on exit if the call released it
         DUMP("calling the args: size=", args.size());
-        out = fun(ct, std::move(args));
+        v = fun(Caller(frame), args, msg);
     }
-    DUMP("got the output ", out.type());
-    if (auto p = out.target<Object const &>()) return *p;
+    if (!v) return false;
+    DUMP("got the output ", v->type());
+    if (auto p = v->target<Object const &>()) out = *p;
     // if (auto p = out.target<PyObject * &>()) return {*p, true};
     // Convert the C++ Variable to a rebind.Variable
-    return variable_cast(std::move(out));
+    else out = variable_cast(std::move(*v));
+    return true;
+}
+
+/// Call an overload, throwing WrongNumber or WrongType if the arguments do not match
+Object call_overload(ErasedFunction const &fun, Sequence &args, bool gil) {
+    Dispatch msg;
+    Object out;
+    if (!call_overload(out, fun, args, gil, msg)) std::move(msg).raise();
+    return out;
+}
+
+/******************************************************************************/
+
+/// Python type for Object arguments, otherwise the C++ type and qualifier
+OverloadKey overload_key(Sequence const &args) {
+    OverloadKey key(Arena::local());
+    key.reserve(args.size());
+    for (auto const &a : args) {
+        if (auto p = a.target<Object const &>()) key.emplace_back((+*p)->ob_type, Value);
+        else key.emplace_back(&a.type().info(), a.qualifier());
+    }
+    return key;
+}
+
+/// Message describing why an overload did not accept its arguments
+Object dispatch_message(Dispatch &&msg) {
+    if (msg.wrong_number) {
+        unsigned int n0 = msg.expected, n = msg.received;
+        return Object::from(PyUnicode_FromFormat("C++: wrong number of arguments (expected %u, got %u)", n0, n));
+    }
+    return as_object(wrong_type_message(std::move(msg).exception()));
+}
+
+/// Call overload and return true. Otherwise keep the reason in failures (or errors, if an exception was thrown)
+bool try_overload(Object &out, ArenaVector<Dispatch> &failures, ArenaVector<Object> &errors, ErasedFunction const &fun, Sequence &args, bool gil) {
+    auto &msg = failures.emplace_back();
+    try {
+        return call_overload(out, fun, args, gil, msg);
+    } catch (WrongType const &e) {
+        errors.emplace_back(as_object(wrong_type_message(e)));
+    } catch (WrongNumber const &e) {
+        unsigned int n0 = e.expected, n = e.received;
+        errors.emplace_back(Object::from(PyUnicode_FromFormat("C++: wrong number of arguments (expected %u, got %u)", n0, n)));
+    } catch (DispatchError const &e) {
+        errors.emplace_back(as_object(std::string_view(e.what())));
+    }
+    failures.pop_back();
+    return false;
 }
 
 /******************************************************************************/
 
 Object function_call_impl(Function const &fun, Sequence args, PyObject *sig, TypeIndex const &t0, TypeIndex const &t1, bool gil) {
+    CallScope scope; // temporaries from argument conversions last until the call returns
     auto const &overloads = fun.overloads;
 
     if (overloads.size() == 1) // only 1 overload
@@ -33,16 +83,39 @@ Object function_call_impl(Function const &fun, Sequence args, PyObject *sig, Typ
         auto i = PyLong_AsLongLong(sig);
         if (i < 0) i += overloads.size();
         if (i <= overloads.size() || i < 0)
-            return call_overload(overloads[i].second, std::move(args), gil);
+            return call_overload(overloads[i].second, args, gil);
         PyErr_SetString(PyExc_IndexError, "signature index out of bounds");
         return Object();
     }
 
-    auto errors = Object::from(PyList_New(0));
+    // Failed overloads are only described if none of them accept the arguments.
+    // Like the key below, they are allocated from the call arena, which the CallScope rewinds
+    auto &arena = Arena::local();
+    ArenaVector<Dispatch> failures(arena);
+    failures.reserve(overloads.size()); // Dispatch is not moved once emplaced
+    ArenaVector<Object> errors(arena);
+    Object out;
+
+    // Try the overload which last accepted the same argument types. An overload is only cached if
+    // every overload before it in the search failed regardless of the argument values (see below),
+    // so trying it first gives the same result as the full search. If it fails, fall through to
+    // the full search (skipping it)
+    bool const use_cache = fun.cache && !sig && !t0 && !t1;
+    bool cacheable = use_cache;
+    OverloadKey key(arena);
+    std::size_t cached = OverloadCache::npos;
+    if (use_cache) {
+        key = overload_key(args);
+        cached = fun.cache->find(key);
+        if (cached != OverloadCache::npos && try_overload(out, failures, errors, overloads[cached].second, args, gil))
+            return out;
+    }
 
     //  Check for equivalence on the first argument first -- provides short-circuiting for methods
     for (auto const exact : {true, false}) {
-        for (auto const &o : overloads) {
+        for (std::size_t index = 0; index != overloads.size(); ++index) {
+            auto const &o = overloads[index];
+            if (index == cached) continue;
             bool const match = (o.first.size() < 2) || (!args.empty() && args[0].type().matches(o.first[1]));
             if (match != exact) continue;
             if (sig) { // check the explicit signature that was passed in
@@ -60,21 +133,23 @@ Object function_call_impl(Function const &fun, Sequence args, PyObject *sig, Typ
                 if (t1 && o.first.size() > 1 && !o.first[1].matches(t1)) continue; // check that the first argument type matches if specified
             }
 
-            try {
-                return call_overload(o.second, args, gil);
-            } catch (WrongType const &e) {
-                if (PyList_Append(+errors, +as_object(wrong_type_message(e)))) return {};
-            } catch (WrongNumber const &e) {
-                unsigned int n0 = e.expected, n = e.received;
-                auto s = Object::from(PyUnicode_FromFormat("C++: wrong number of arguments (expected %u, got %u)", n0, n));
-                if (PyList_Append(+errors, +s)) return {};
-            } catch (DispatchError const &e) {
-                if (PyList_Append(+errors, +as_object(std::string_view(e.what())))) return {};
+            auto const n_errors = errors.size();
+            if (try_overload(out, failures, errors, o.second, args, gil)) {
+                if (cacheable) fun.cache->emplace(key, index);
+                return out;
             }
+            // Only a wrong number of arguments is known to fail for every call with the same key;
+            // any other conversion failure might have depended on the values
+            if (errors.size() != n_errors || !failures.back().wrong_number) cacheable = false;
         }
     }
     // Raise an exception with a list of the messages
-    return PyErr_SetObject(TypeError, +errors), nullptr;
+    auto messages = Object::from(PyList_New(0));
+    for (auto &msg : failures)
+        if (PyList_Append(+messages, +dispatch_message(std::move(msg)))) return {};
+    for (auto const &e : errors)
+        if (PyList_Append(+messages, +e)) return {};
+    return PyErr_SetObject(TypeError, +messages), nullptr;
 }
 
 /******************************************************************************/
@@ -98,6 +173,24 @@ auto function_call_keywords(PyObject *kws) {
     return std::make_tuple(t0, t1, sig, gil);
 }
 
+#ifdef REBIND_VECTORCALL
+/// Same as above, but for the keyword values kws and names kwnames of a vectorcall
+auto function_call_keywords(PyObject *const *kws, PyObject *kwnames) {
+    bool gil = true;
+    TypeIndex t0, t1;
+    PyObject *sig=nullptr;
+    Py_ssize_t const n = kwnames ? PyTuple_GET_SIZE(kwnames) : 0;
+    for (Py_ssize_t i = 0; i != n; ++i) {
+        PyObject *k = PyTuple_GET_ITEM(kwnames, i);
+        if (!PyUnicode_CompareWithASCIIString(k, "gil")) gil = PyObject_IsTrue(kws[i]);
+        else if (!PyUnicode_CompareWithASCIIString(k, "signature")) sig = not_none(kws[i]);
+        else if (!PyUnicode_CompareWithASCIIString(k, "return_type")) {if (not_none(kws[i])) t0 = cast_object<TypeIndex>(kws[i]);}
+        else if (!PyUnicode_CompareWithASCIIString(k, "first_type")) {if (not_none(kws[i])) t1 = cast_object<TypeIndex>(kws[i]);}
+    }
+    return std::make_tuple(t0, t1, sig, gil);
+}
+#endif
+
 /******************************************************************************/
 
 struct AnnotatedFunction {
@@ -160,8 +253,82 @@ PyObject *function_annotated(PyObject *self, PyObject *args) noexcept {
 
 /******************************************************************************/
 
+#ifdef REBIND_VECTORCALL
+/// Single-entry cache of the incoming kwnames tuple and the kwnames tuple which includes "_fun_".
+/// On free-threaded builds it is guarded by the critical section of the object which owns it
+struct DelegatingNames {
+    Object key, value;
+    Py_ssize_t position = 0; // index of "_fun_" in value
+
+    /// The kwnames tuple including "_fun_", and the index of "_fun_" in it
+    std::pair<Object, Py_ssize_t> operator()(PyObject *owner, PyObject *kwnames) {
+        std::pair<Object, Py_ssize_t> out;
+#ifdef Py_GIL_DISABLED
+        Py_BEGIN_CRITICAL_SECTION(owner);
+#endif
+        if (value && +key == kwnames) out = {value, position};
+#ifdef Py_GIL_DISABLED
+        Py_END_CRITICAL_SECTION();
+#endif
+        if (out.first) return out;
+
+        Py_ssize_t const n = kwnames ? PyTuple_GET_SIZE(kwnames) : 0;
+        for (out.second = 0; out.second != n; ++out.second)
+            if (!PyUnicode_CompareWithASCIIString(PyTuple_GET_ITEM(kwnames, out.second), "_fun_")) break;
+        if (out.second != n) {
+            out.first = {kwnames, true};
+        } else {
+            out.first = Object::from(PyTuple_New(n + 1));
+            for (Py_ssize_t i = 0; i != n; ++i) set_tuple_item(out.first, i, PyTuple_GET_ITEM(kwnames, i));
+            if (!set_tuple_item(out.first, n, as_object(std::string_view("_fun_")))) throw python_error();
+        }
+
+        Object k(kwnames, true), v = out.first;
+#ifdef Py_GIL_DISABLED
+        Py_BEGIN_CRITICAL_SECTION(owner);
+#endif
+        swap(key, k);
+        swap(value, v);
+        position = out.second;
+#ifdef Py_GIL_DISABLED
+        Py_END_CRITICAL_SECTION();
+#endif
+        return out; // the old key and value are released here, outside of the critical section
+    }
+};
+
+/// Call wrapping(self, *args, **kws, _fun_=function) without making a new tuple or dict
+Object delegating_call(Object const &wrapping, Object const &function, PyObject *self,
+                       PyObject *const *args, std::size_t nargsf, PyObject *kwnames, PyObject *owner, DelegatingNames &names) {
+    auto const names2 = names(owner, kwnames);
+    std::size_t const nargs = PyVectorcall_NARGS(nargsf);
+    std::size_t const nkws = PyTuple_GET_SIZE(+names2.first);
+    std::size_t const offset = self ? 2 : 1; // leading slot for PY_VECTORCALL_ARGUMENTS_OFFSET
+    PyObject *stack[8];
+    std::vector<PyObject *> heap;
+    PyObject **buff = stack;
+    if (offset + nargs + nkws > std::size(stack)) buff = (heap.resize(offset + nargs + nkws), heap.data());
+    if (self) buff[1] = self;
+    std::copy(args, args + nargs + (kwnames ? PyTuple_GET_SIZE(kwnames) : 0), buff + offset);
+    buff[offset + nargs + names2.second] = +function;
+    return Object::from(PyObject_Vectorcall(+wrapping, buff + 1, (offset - 1 + nargs) | PY_VECTORCALL_ARGUMENTS_OFFSET, +names2.first));
+}
+#endif
+
+/******************************************************************************/
+
 struct DelegatingMethod {
     Object function, wrapping, captured_self;
+#ifdef REBIND_VECTORCALL
+    DelegatingNames names;
+
+    static PyObject *vectorcall(PyObject *self, PyObject *const *args, std::size_t nargsf, PyObject *kwnames) noexcept {
+        return raw_object([=] {
+            auto &s = cast_object<DelegatingMethod>(self);
+            return delegating_call(s.wrapping, s.function, +s.captured_self, args, nargsf, kwnames, self, s.names);
+        });
+    }
+#endif
 
     static PyObject *call(PyObject *self, PyObject *args, PyObject *kws) noexcept {
         return raw_object([=] {
@@ -181,6 +348,9 @@ template <>
 PyTypeObject Holder<DelegatingMethod>::type = []{
     auto t = type_definition<DelegatingMethod>("rebind.DelegatingMethod", "C++ delegating method");
     t.tp_call = DelegatingMethod::call;
+#ifdef REBIND_VECTORCALL
+    define_vectorcall<DelegatingMethod, DelegatingMethod::vectorcall>(t);
+#endif
     return t;
 }();
 
@@ -188,6 +358,16 @@ PyTypeObject Holder<DelegatingMethod>::type = []{
 
 struct DelegatingFunction {
     Object function, wrapping;
+#ifdef REBIND_VECTORCALL
+    DelegatingNames names;
+
+    static PyObject *vectorcall(PyObject *self, PyObject *const *args, std::size_t nargsf, PyObject *kwnames) noexcept {
+        return raw_object([=] {
+            auto &s = cast_object<DelegatingFunction>(self);
+            return delegating_call(s.wrapping, s.function, nullptr, args, nargsf, kwnames, self, s.names);
+        });
+    }
+#endif
 
     static PyObject *call(PyObject *self, PyObject *args, PyObject *kws) noexcept {
         return raw_object([=] {
@@ -219,6 +399,9 @@ PyTypeObject Holder<DelegatingFunction>::type = []{
     auto t = type_definition<DelegatingFunction>("rebind.DelegatingFunction", "C++ delegating function");
     t.tp_call = DelegatingFunction::call;
     t.tp_descr_get = DelegatingFunction::get;
+#ifdef REBIND_VECTORCALL
+    define_vectorcall<DelegatingFunction, DelegatingFunction::vectorcall>(t);
+#endif
     return t;
 }();
 
@@ -239,6 +422,21 @@ struct Method {
         });
     }
 
+#ifdef REBIND_VECTORCALL
+    static PyObject *vectorcall(PyObject *self, PyObject *const *pyargs, std::size_t nargsf, PyObject *kwnames) noexcept {
+        return raw_object([=] {
+            auto const &s = cast_object<Method>(self);
+            std::size_t const n = PyVectorcall_NARGS(nargsf);
+            auto [t0, t1, sig, gil] = function_call_keywords(pyargs + n, kwnames);
+            Sequence args;
+            args.reserve(n + 1);
+            args.emplace_back(variable_reference_from_object(s.self));
+            args_from_python(args, pyargs, n);
+            return function_call_impl(s.fun, std::move(args), sig, t0, t1, gil);
+        });
+    }
+#endif
+
     static PyObject *make(PyObject *self, PyObject *object, PyObject *type) {
         return raw_object([=]() -> Object {
             if (!object) return {self, true};
@@ -252,6 +450,9 @@ template <>
 PyTypeObject Holder<Method>::type = []{
     auto o = type_definition<Method>("rebind.Method", "Bound method");
     o.tp_call = Method::call;
+#ifdef REBIND_VECTORCALL
+    define_vectorcall<Method, Method::vectorcall>(o);
+#endif
     return o;
 }();
 
@@ -276,6 +477,19 @@ PyObject * function_call(PyObject *self, PyObject *pyargs, PyObject *kws) noexce
     });
 }
 
+#ifdef REBIND_VECTORCALL
+/// Vectorcall (PEP 590) version of function_call: keywords are only parsed if given
+PyObject * function_vectorcall(PyObject *self, PyObject *const *pyargs, std::size_t nargsf, PyObject *kwnames) noexcept {
+    return raw_object([=] {
+        std::size_t const n = PyVectorcall_NARGS(nargsf);
+        auto const [t0, t1, sig, gil] = function_call_keywords(pyargs + n, kwnames);
+        Sequence args;
+        args_from_python(args, pyargs, n);
+        return function_call_impl(cast_object<Function>(self), std::move(args), sig, t0, t1, gil);
+    });
+}
+#endif
+
 /******************************************************************************/
 
 PyObject * function_signatures(PyObject *self, PyObject *) noexcept {
@@ -326,23 +540,13 @@ PyTypeObject Holder<Function>::type = []{
     o.tp_call = function_call;
     o.tp_methods = FunctionTypeMethods;
     o.tp_descr_get = Method::make;
+#ifdef REBIND_VECTORCALL
+    define_vectorcall<Function, function_vectorcall>(o);
+#endif
     return o;
 }();
 
 
-    // offsetof(PyCFunctionObject, vectorcall),    /* tp_vectorcall_offset */
-    // // (reprfunc)meth_repr,                        /* tp_repr */
-    // (hashfunc)meth_hash,                        /* tp_hash */
-    // PyCFunction_Call,                           /* tp_call */
-    // PyObject_GenericGetAttr,                    /* tp_getattro */
-    // Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_GC | _Py_TPFLAGS_HAVE_VECTORCALL,                /* tp_flags */
-    // (traverseproc)meth_traverse,                /* tp_traverse */
-    // meth_richcompare,                           /* tp_richcompare */
-    // offsetof(PyCFunctionObject, m_weakreflist), /* tp_weaklistoffset */
-    // meth_methods,                               /* tp_methods */
-    // meth_members,                               /* tp_members */
-    // meth_getsets,                               /* tp_getset */
-
 
 /******************************************************************************/
 
@@ -4,10 +4,63 @@ namespace rebind {
 
 Object UnionType, TypeError;
 
-std::unordered_map<Object, Object> type_translations{}, output_conversions{}, input_conversions{};
+Registry<Object, Object> type_translations{}, output_conversions{}, input_conversions{};
 
-std::unordered_map<std::type_index, Object> python_types{};
+Registry<TypeIndex, Object> python_types{};
 
+std::atomic<bool> ZeroCopyBytes{false};
+
+
+/******************************************************************************/
+
+namespace {
+
+/// A type's version tag, or 0 if it has none. Tags are never reused, so unlike the address
+/// they identify a type which may have been freed and another allocated in its place
+unsigned int type_version(PyTypeObject *t) noexcept {
+#if PY_VERSION_HEX >= 0x030C0000
+    return PyUnstable_Type_AssignVersionTag(t) ? t->tp_version_tag : 0;
+#else
+    return PyType_HasFeature(t, Py_TPFLAGS_VALID_VERSION_TAG) ? t->tp_version_tag : 0;
+#endif
+}
+
+using Conversions = Registry<Object, Object>::Map;
+
+/// Borrowed converters of one type. Registry values stay valid until a registry is cleared,
+/// which changes RegistryVersion and so invalidates the entry
+struct ConverterCacheEntry {
+    PyTypeObject *type = nullptr;
+    unsigned int version = 0;
+    std::size_t registry = 0;
+    PyObject *input = nullptr, *translation = nullptr, *output = nullptr;
+};
+
+PyObject *lookup(Conversions const &m, Object const &key) {
+    auto it = m.find(key);
+    return it == m.end() ? nullptr : +it->second;
+}
+
+}
+
+TypeConverters type_converters(PyTypeObject *t) noexcept {
+    // Read the registry version first: if it is current, so are the maps read below
+    std::size_t const registry = RegistryVersion.load(std::memory_order_acquire);
+    unsigned int const version = type_version(t);
+    // Direct-mapped and per thread, so lookups need no lock with or without the GIL
+    thread_local ConverterCacheEntry cache[64];
+    auto &e = cache[(reinterpret_cast<std::uintptr_t>(t) >> 4) % 64];
+    if (!version || e.type != t || e.version != version || e.registry != registry) {
+        Object const key(reinterpret_cast<PyObject *>(t), true);
+        e = {t, version, registry, lookup(input_conversions.snapshot(), key),
+             lookup(type_translations.snapshot(), key), lookup(output_conversions.snapshot(), key)};
+        if (!version) e.type = nullptr; // looked up, but not reusable
+    }
+    // New references, which stay valid even if the entry is replaced during a conversion
+    return {Object(e.input, true), Object(e.translation, true), Object(e.output, true)};
+}
+
+/******************************************************************************/
 
 void initialize_global_objects() {
     TypeError = {PyExc_TypeError, true};
@@ -26,7 +79,7 @@ void clear_global_objects() {
     TypeError = nullptr;
 }
 
-std::unordered_map<TypeIndex, std::string> type_names = {
+Registry<TypeIndex, std::string> type_names = {
     {typeid(void),             "void"},
     {typeid(void *),           "pointer"},
     {typeid(PyObject),         "PyObject"},
@@ -38,6 +91,7 @@ std::unordered_map<TypeIndex, std::string> type_names = {
     {typeid(TypeIndex),        "TypeIndex"},
     {typeid(Binary),           "Binary"},
     {typeid(BinaryData),       "BinaryData"},
+    {typeid(BinaryView),       "BinaryView"},
     {typeid(ArrayView),        "ArrayView"},
     {typeid(Function),         "Function"},
     {typeid(Variable),         "Variable"},
@@ -61,28 +115,6 @@ std::unordered_map<TypeIndex, std::string> type_names = {
 };
 
 
-Zip<std::string_view, std::type_info const *> Buffer::formats = {
-    {"d", &typeid(double)},
-    {"f", &typeid(float)},
-    {"c", &typeid(char)},
-    {"b", &typeid(signed char)},
-    {"B", &typeid(unsigned char)},
-    {"?", &typeid(bool)},
-    {"h", &typeid(short)},
-    {"H", &typeid(unsigned short)},
-    {"i", &typeid(int)},
-    {"I", &typeid(unsigned int)},
-    {"l", &typeid(long)},
-    {"L", &typeid(unsigned long)},
-    {"q", &typeid(long long)},
-    {"Q", &typeid(unsigned long long)},
-    {"n", &typeid(ssize_t)},
-    {"s", &typeid(char[])},
-    {"p", &typeid(char[])},
-    {"N", &typeid(size_t)},
-    {"P", &typeid(void *)}
-};
-
 #define REBIND_TMP(C, T) {Scalar::C, typeid(T), sizeof(T) * CHAR_BIT}
 
 Zip<Scalar, TypeIndex, unsigned> scalars = {
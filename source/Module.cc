@@ -33,30 +33,37 @@ namespace rebind {
 
 /******************************************************************************/
 
-int array_data_buffer(PyObject *self, Py_buffer *view, int flags) noexcept {
-    auto p = cast_if<ArrayBuffer>(self);
-    if (!p) return 1;
-    view->buf = p->data;
-
-    view->itemsize = Buffer::itemsize(*p->type);
-    view->len = p->n_elem;
-    view->readonly = !p->mutate;
-    view->format = const_cast<char *>(Buffer::format(*p->type).data());
-    view->ndim = p->shape_stride.size() / 2;
-    view->shape = p->shape_stride.data();
-    view->strides = p->shape_stride.data() + view->ndim;
+int BufferLayout::export_to(PyObject *self, Py_buffer *view, int flags) noexcept {
+    auto const format = type ? Buffer::format(*type) : std::string_view();
+    if (format.empty()) return PyErr_SetString(PyExc_BufferError, "C++: array element type has no buffer format"), -1;
+    if (swap) return PyErr_SetString(PyExc_BufferError, "C++: array is not in native byte order"), -1;
+    if ((flags & PyBUF_WRITABLE) && !mutate) return PyErr_SetString(PyExc_BufferError, "C++: array is not writable"), -1;
+    view->buf = data;
+    view->itemsize = Buffer::itemsize(*type);
+    view->len = n_elem * view->itemsize;
+    view->readonly = !mutate;
+    view->format = const_cast<char *>(format.data());
+    view->ndim = shape_stride.size() / 2;
+    view->shape = shape_stride.data();
+    view->strides = shape_stride.data() + view->ndim;
     view->suboffsets = nullptr;
+    view->internal = nullptr;
     view->obj = self;
-    ++p->exports;
-    DUMP("allocating new array buffer", bool(p->base));
+    ++exports;
     incref(view->obj);
     return 0;
 }
 
+int array_data_buffer(PyObject *self, Py_buffer *view, int flags) noexcept {
+    auto p = cast_if<ArrayBuffer>(self);
+    if (!p) return type_error("expected rebind.ArrayBuffer"), -1;
+    DUMP("allocating new array buffer", bool(p->base));
+    return p->export_to(self, view, flags);
+}
+
 void array_data_release(PyObject *self, Py_buffer *view) noexcept {
-    // auto &p  = cast_object<ArrayBuffer>(self)
-    // --p.exports;
-    // if (p.exports)
+    // Python releases the reference in view->obj itself after this returns
+    if (auto p = cast_if<ArrayBuffer>(self)) --p->exports;
     DUMP("releasing array buffer");
 }
 
@@ -73,7 +80,7 @@ PyTypeObject Holder<ArrayBuffer>::type = []{
 
 PyObject *type_index_new(PyTypeObject *subtype, PyObject *, PyObject *) noexcept {
     PyObject* o = subtype->tp_alloc(subtype, 0); // 0 unused
-    if (o) new (&cast_object<TypeIndex>(o)) TypeIndex(typeid(void)); // noexcept
+    if (o) new (&cast_object<TypeIndex>(o)) TypeIndex(Type<void>()); // noexcept once initialized
     return o;
 }
 
@@ -125,10 +132,13 @@ bool attach(Object const &m, char const *name, Object o) noexcept {
 
 Object initialize(Document const &doc) {
     initialize_global_objects();
+    type_id<void>(); // intern void here, so that type_index_new cannot throw
 
     auto m = Object::from(PyDict_New());
-    for (auto const &p : doc.types)
-        if (p.second) type_names.emplace(p.first, p.first.name());//p.second->first);
+    type_names.update([&](auto &names) {
+        for (auto const &p : doc.types)
+            if (p.second) names.emplace(p.first, p.first.name());//p.second->first);
+    });
 
     if (PyType_Ready(type_object<ArrayBuffer>()) < 0) return {};
     incref(type_object<ArrayBuffer>());
@@ -169,14 +179,22 @@ Object initialize(Document const &doc) {
         && attach(m, "clear_global_objects", as_object(Function::of(&clear_global_objects)))
         && attach(m, "set_debug", as_object(Function::of([](bool b) {return std::exchange(Debug, b);})))
         && attach(m, "debug", as_object(Function::of([] {return Debug;})))
+        && attach(m, "set_zero_copy_bytes", as_object(Function::of([](bool b) {return ZeroCopyBytes.exchange(b);})))
+        && attach(m, "zero_copy_bytes", as_object(Function::of([] {return ZeroCopyBytes.load();})))
+        && attach(m, "pool_statistics", as_object(Function::of([] {
+            auto const s = pool_statistics();
+            return args_as_tuple(as_object(Integer(s.hits)), as_object(Integer(s.misses)), as_object(Integer(s.oversize)));
+        })))
         && attach(m, "set_type_error", as_object(Function::of([](Object o) {TypeError = std::move(o);})))
         && attach(m, "set_type", as_object(Function::of([](TypeIndex idx, Object o) {
             DUMP("set_type in");
-            python_types.emplace(idx.info(), std::move(o));
+            python_types.emplace(+idx, std::move(o));
             DUMP("set_type out");
         })))
         && attach(m, "set_type_names", as_object(Function::of([](Zip<TypeIndex, std::string_view> v) {
-            for (auto const &p : v) type_names.insert_or_assign(p.first, p.second);
+            type_names.update([&](auto &names) {
+                for (auto const &p : v) names.insert_or_assign(p.first, std::string(p.second));
+            });
         })));
     return ok ? m : Object();
 }
@@ -205,6 +223,10 @@ extern "C" {
         return rebind::raw_object([&]() -> rebind::Object {
             rebind::Object mod {PyModule_Create(&rebind_definition), true};
             if (!mod) return {};
+#ifdef Py_GIL_DISABLED
+            // Registries and per-call state are thread-safe, so free-threaded builds keep the GIL off
+            if (PyUnstable_Module_SetGIL(+mod, Py_MOD_GIL_NOT_USED) < 0) return {};
+#endif
             rebind::init(rebind::document());
             rebind::Object dict = initialize(rebind::document());
             if (!dict) return {};
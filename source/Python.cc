@@ -4,7 +4,11 @@
  */
 #include <rebind-python/API.h>
 #include <rebind/Document.h>
+#include <cmath>
 #include <complex>
+#include <limits>
+#include <array>
+#include <unordered_map>
 #include <any>
 #include <iostream>
 
@@ -42,23 +46,153 @@ PythonError python_error(std::nullptr_t) noexcept {
 
 /******************************************************************************/
 
+namespace {
+
+/// Kind and native/standard sizes of a PEP 3118 character code (standard size 0 means native only)
+struct FormatCode {
+    ScalarKind kind = ScalarKind::none;
+    unsigned char native = 0, standard = 0;
+};
+
+constexpr auto format_codes = [] {
+    using K = ScalarKind;
+    std::array<FormatCode, 128> t{};
+    t['?'] = {K::boolean, sizeof(bool), 1};
+    t['c'] = {K::character, 1, 1};
+    t['b'] = {K::signed_integer, 1, 1};
+    t['B'] = {K::unsigned_integer, 1, 1};
+    t['h'] = {K::signed_integer, sizeof(short), 2};
+    t['H'] = {K::unsigned_integer, sizeof(short), 2};
+    t['i'] = {K::signed_integer, sizeof(int), 4};
+    t['I'] = {K::unsigned_integer, sizeof(int), 4};
+    t['l'] = {K::signed_integer, sizeof(long), 4};
+    t['L'] = {K::unsigned_integer, sizeof(long), 4};
+    t['q'] = {K::signed_integer, sizeof(long long), 8};
+    t['Q'] = {K::unsigned_integer, sizeof(long long), 8};
+    t['n'] = {K::signed_integer, sizeof(Py_ssize_t), 0};
+    t['N'] = {K::unsigned_integer, sizeof(std::size_t), 0};
+    t['f'] = {K::floating, sizeof(float), 4};
+    t['d'] = {K::floating, sizeof(double), 8};
+    t['g'] = {K::floating, sizeof(long double), 0};
+    t['P'] = {K::pointer, sizeof(void *), 0};
+    t['s'] = {K::string, 1, 1};
+    t['p'] = {K::string, 1, 1};
+    return t;
+}();
+
+constexpr bool little_endian = PY_LITTLE_ENDIAN;
+
+/// Exact C type of a code in native mode
+std::type_info const *native_format(char c) noexcept {
+    switch (c) {
+        case '?': return &typeid(bool);
+        case 'c': return &typeid(char);
+        case 'b': return &typeid(signed char);
+        case 'B': return &typeid(unsigned char);
+        case 'h': return &typeid(short);
+        case 'H': return &typeid(unsigned short);
+        case 'i': return &typeid(int);
+        case 'I': return &typeid(unsigned int);
+        case 'l': return &typeid(long);
+        case 'L': return &typeid(unsigned long);
+        case 'q': return &typeid(long long);
+        case 'Q': return &typeid(unsigned long long);
+        case 'n': return &typeid(Py_ssize_t);
+        case 'N': return &typeid(std::size_t);
+        case 'f': return &typeid(float);
+        case 'd': return &typeid(double);
+        case 'g': return &typeid(long double);
+        case 'P': return &typeid(void *);
+        case 's': return &typeid(char[]);
+        case 'p': return &typeid(char[]);
+        default: return nullptr;
+    }
+}
+
+std::type_info const *complex_format(std::type_info const *t) noexcept {
+    if (t == &typeid(float)) return &typeid(std::complex<float>);
+    if (t == &typeid(double)) return &typeid(std::complex<double>);
+    if (t == &typeid(long double)) return &typeid(std::complex<long double>);
+    return nullptr;
+}
+
+}
+
+BufferFormat Buffer::parse(std::string_view s) noexcept {
+    BufferFormat out;
+    auto it = s.begin();
+    // Byte order, size and alignment
+    bool native = true, swap = false;
+    if (it != s.end()) switch (*it) {
+        case '@': ++it; break;
+        case '^': ++it; break;
+        case '=': ++it; native = false; break;
+        case '<': ++it; native = false; swap = !little_endian; break;
+        case '>': ++it; native = false; swap = little_endian; break;
+        case '!': ++it; native = false; swap = little_endian; break;
+    }
+    // Repeat count
+    if (it != s.end() && '0' <= *it && *it <= '9') {
+        out.count = 0;
+        for (; it != s.end() && '0' <= *it && *it <= '9'; ++it) out.count = 10 * out.count + (*it - '0');
+    }
+    bool const complex = it != s.end() && *it == 'Z';
+    if (complex) ++it;
+    // Exactly one code must remain (structs and multiple items are not supported)
+    if (it == s.end() || std::next(it) != s.end() || static_cast<unsigned char>(*it) >= format_codes.size()) return out;
+    auto const c = *it;
+    auto const &code = format_codes[static_cast<unsigned char>(c)];
+    if (code.kind == ScalarKind::none || (complex && code.kind != ScalarKind::floating)) return out;
+    if (!native && !code.standard) return out;
+
+    std::size_t size = native ? code.native : code.standard;
+    auto t = native ? native_format(c) : scalar_type(code.kind, code.standard);
+    if (complex) {
+        t = complex_format(t);
+        size *= 2;
+    }
+    if (!t) return out;
+    out.type = t;
+    out.itemsize = size * out.count;
+    out.swap = swap && (native ? code.native : code.standard) > 1;
+    return out;
+}
+
 /// type_index from PyBuffer format string (excludes constness)
 std::type_info const & Buffer::format(std::string_view s) {
-    auto it = std::find_if(Buffer::formats.begin(), Buffer::formats.end(),
-        [&](auto const &p) {return p.first == s;});
-    return it == Buffer::formats.end() ? typeid(void) : *it->second;
+    auto const f = parse(s);
+    return f ? *f.type : typeid(void);
+}
+
+namespace {
+
+/// Native format and item size of each exportable type
+std::unordered_map<TypeIndex, std::pair<std::string_view, std::size_t>> const & export_formats() {
+    static std::unordered_map<TypeIndex, std::pair<std::string_view, std::size_t>> const formats = [] {
+        std::unordered_map<TypeIndex, std::pair<std::string_view, std::size_t>> m;
+        for (char const *c : {"?", "c", "b", "B", "h", "H", "i", "I", "l", "L", "q", "Q", "n", "N", "f", "d", "g", "P", "Zf", "Zd", "Zg"}) {
+            auto const f = Buffer::parse(c);
+            m.try_emplace(*f.type, c, f.itemsize);
+        }
+        m.try_emplace(typeid(std::byte), "B", 1); // Binary is exported as unsigned bytes
+        for (auto const &s : scalars) m.try_emplace(std::get<1>(s), std::string_view(), std::get<2>(s) / CHAR_BIT);
+        return m;
+    }();
+    return formats;
+}
+
 }
 
 std::string_view Buffer::format(std::type_info const &t) {
-    auto it = std::find_if(Buffer::formats.begin(), Buffer::formats.end(),
-        [&](auto const &p) {return p.second == &t;});
-    return it == Buffer::formats.end() ? std::string_view() : it->first;
+    auto const &m = export_formats();
+    auto it = m.find(t);
+    return it == m.end() ? std::string_view() : it->second.first;
 }
 
 std::size_t Buffer::itemsize(std::type_info const &t) {
-    auto it = std::find_if(scalars.begin(), scalars.end(),
-        [&](auto const &p) {return std::get<1>(p) == t;});
-    return it == scalars.end() ? 0u : std::get<2>(*it) / CHAR_BIT;
+    auto const &m = export_formats();
+    auto it = m.find(t);
+    return it == m.end() ? 0u : it->second.second;
 }
 
 /******************************************************************************/
@@ -84,19 +218,44 @@ std::string_view from_bytes(PyObject *o) {
 
 /******************************************************************************/
 
+/// Value of a Python int or float as T, or nothing if it is not representable (any error is cleared)
+template <class T>
+std::optional<T> checked_arithmetic(PyObject *o) {
+    if constexpr(std::is_floating_point_v<T>) {
+        auto const d = PyFloat_AsDouble(o); // an int too large for a double raises OverflowError
+        if (d == -1.0 && PyErr_Occurred()) return PyErr_Clear(), std::nullopt;
+        return static_cast<T>(d);
+    } else if (PyFloat_Check(o)) {
+        // Only floats with an exact integer value, in range, are converted (so never NaN or inf)
+        auto const d = PyFloat_AS_DOUBLE(o);
+        if constexpr(!std::is_same_v<T, bool>) {
+            static_assert(std::is_signed_v<T>, "expected a signed integer such as Integer");
+            auto const lo = static_cast<double>(std::numeric_limits<T>::min()); // exactly -2^(N-1)
+            if (!(d == std::trunc(d) && d >= lo && d < -lo)) return std::nullopt;
+        }
+        return static_cast<T>(d);
+    } else {
+        auto const i = PyLong_AsLongLong(o);
+        if (i == -1 && PyErr_Occurred()) return PyErr_Clear(), std::nullopt;
+        return static_cast<T>(i);
+    }
+}
+
 template <class T>
 bool to_arithmetic(Object const &o, Variable &v) {
     DUMP("cast arithmetic in: ", v.type());
-    if (PyFloat_Check(o)) return v = static_cast<T>(PyFloat_AsDouble(+o)), true;
-    if (PyLong_Check(o)) return v = static_cast<T>(PyLong_AsLongLong(+o)), true;
     if (PyBool_Check(o)) return v = static_cast<T>(+o == Py_True), true;
+    if (PyFloat_Check(o) || PyLong_Check(o)) {
+        if (auto t = checked_arithmetic<T>(+o)) return v = *t, true;
+        return false;
+    }
     if (PyNumber_Check(+o)) { // This can be hit for e.g. numpy.int64
         if (std::is_integral_v<T>) {
             if (auto i = Object::from(PyNumber_Long(+o)))
-                return v = static_cast<T>(PyLong_AsLongLong(+i)), true;
+                if (auto t = checked_arithmetic<T>(+i)) return v = *t, true;
         } else {
             if (auto i = Object::from(PyNumber_Float(+o)))
-               return v = static_cast<T>(PyFloat_AsDouble(+i)), true;
+                if (auto t = checked_arithmetic<T>(+i)) return v = *t, true;
         }
     }
     DUMP("cast arithmetic out: ", v.type());
@@ -105,7 +264,87 @@ bool to_arithmetic(Object const &o, Variable &v) {
 
 /******************************************************************************/
 
-bool object_response(Variable &v, TypeIndex t, Object o) {
+/// Keep a buffer exported until the enclosing call returns, by storing it in the call arena
+Buffer &pin_buffer(Buffer &&b) {return *Arena::local().make<Buffer>(std::move(b));}
+
+/******************************************************************************/
+
+/// Convert a list item without the PyNumber fallback of to_arithmetic; false leaves it to the general path
+template <class T>
+bool list_item(PyObject *o, T &out) {
+    if constexpr(std::is_same_v<T, std::string>) {
+        if (PyUnicode_Check(o)) return out = from_unicode(o), true;
+        if (PyBytes_Check(o)) return out = from_bytes(o), true;
+        return false;
+    } else if constexpr(std::is_floating_point_v<T>) {
+        if (PyFloat_CheckExact(o)) return out = static_cast<T>(PyFloat_AS_DOUBLE(o)), true;
+        if (PyBool_Check(o)) return out = static_cast<T>(o == Py_True), true;
+        if (PyFloat_Check(o) || PyLong_Check(o)) {
+            auto const d = PyFloat_AsDouble(o); // an int too large for a double raises OverflowError
+            if (d == -1.0 && PyErr_Occurred()) return PyErr_Clear(), false;
+            return out = static_cast<T>(d), true;
+        }
+        return false;
+    } else {
+        // Floats are not truncated, and out of range integers are not wrapped
+        if (PyBool_Check(o)) return out = static_cast<T>(o == Py_True), true;
+        if (!PyLong_Check(o)) return false;
+        if constexpr(std::is_same_v<T, bool>) {
+            return out = PyObject_IsTrue(o), true;
+        } else if constexpr(std::is_unsigned_v<T>) {
+            auto const i = PyLong_AsUnsignedLongLong(o); // a negative int raises OverflowError
+            if (i == static_cast<unsigned long long>(-1) && PyErr_Occurred()) return PyErr_Clear(), false;
+            if (i > std::numeric_limits<T>::max()) return false;
+            return out = static_cast<T>(i), true;
+        } else {
+            auto const i = PyLong_AsLongLong(o);
+            if (i == -1 && PyErr_Occurred()) return PyErr_Clear(), false;
+            if (i < std::numeric_limits<T>::min() || i > std::numeric_limits<T>::max()) return false;
+            return out = static_cast<T>(i), true;
+        }
+    }
+}
+
+/// Convert a list or tuple to std::vector<T> in one pass over its borrowed items, without making a Sequence
+template <class T>
+bool list_to_vector(Variable &v, Object const &o) {
+    bool ok = true;
+    std::vector<T> out;
+#ifdef Py_GIL_DISABLED
+    // Without the GIL another thread may resize a list while its items are being read
+    Py_BEGIN_CRITICAL_SECTION(+o);
+#endif
+    auto const n = PySequence_Fast_GET_SIZE(+o);
+    PyObject **items = PySequence_Fast_ITEMS(+o);
+    out.resize(n);
+    if constexpr(std::is_same_v<T, bool>) {
+        for (Py_ssize_t i = 0; ok && i != n; ++i) {
+            bool b;
+            ok = list_item(items[i], b);
+            out[i] = b;
+        }
+    } else {
+        for (Py_ssize_t i = 0; ok && i != n; ++i) ok = list_item(items[i], out[i]);
+    }
+#ifdef Py_GIL_DISABLED
+    Py_END_CRITICAL_SECTION();
+#endif
+    return ok && (v.emplace(Type<std::vector<T>>(), std::move(out)), true);
+}
+
+using ListScalars = Pack<double, float, bool, short, unsigned short, int, unsigned int,
+    long, unsigned long, long long, unsigned long long, std::string>;
+
+template <class ...Ts>
+bool list_response(Variable &v, TypeIndex const &t, Object const &o, Pack<Ts...>) {
+    bool out = false;
+    ((t.equals<std::vector<Ts>>() ? (out = list_to_vector<Ts>(v, o), true) : false) || ...);
+    return out;
+}
+
+/******************************************************************************/
+
+bool object_response(Variable &v, TypeIndex t, Object const &o) {
     if (Debug) {
         auto repr = Object::from(PyObject_Repr(SubClass<PyTypeObject>{(+o)->ob_type}));
         DUMP("input object reference count ", reference_count(o));
@@ -149,6 +388,9 @@ bool object_response(Variable &v, TypeIndex t, Object o) {
         } else return false;
     }
 
+    if (PyList_Check(+o) || PyTuple_Check(+o))
+        if (list_response(v, t, o, ListScalars())) return true;
+
     if (t.equals<Real>())
         return to_arithmetic<Real>(o, v);
 
@@ -164,7 +406,12 @@ bool object_response(Variable &v, TypeIndex t, Object o) {
     if (t.equals<std::string_view>()) {
         if (PyUnicode_Check(+o)) return v.emplace(Type<std::string_view>(), from_unicode(+o)), true;
         if (PyBytes_Check(+o)) return v.emplace(Type<std::string_view>(), from_bytes(+o)), true;
-        return false;
+        // Other read-only bytes-like objects are viewed while pinned in the call arena (see BinaryView)
+        if (!PyObject_CheckBuffer(+o) || !Arena::local().scopes) return false;
+        Buffer buff(+o, PyBUF_SIMPLE);
+        if (!buff) return PyErr_Clear(), false;
+        auto const &view = pin_buffer(std::move(buff)).view;
+        return v.emplace(Type<std::string_view>(), static_cast<char const *>(view.buf), static_cast<std::size_t>(view.len)), true;
     }
 
     if (t.equals<std::string>()) {
@@ -173,24 +420,68 @@ bool object_response(Variable &v, TypeIndex t, Object o) {
         return false;
     }
 
+    if (t.equals<BinaryView>()) {
+        if (PyBytes_Check(+o)) { // immutable, and kept alive by the caller for the whole call
+            auto const s = from_bytes(+o);
+            return v.emplace(Type<BinaryView>(), reinterpret_cast<BinaryType const *>(s.data()), s.size()), true;
+        }
+        // The buffer is pinned in the call arena, so that the data can be neither resized nor
+        // released before the call finishes; outside of a call there is nowhere to pin it
+        if (!PyObject_CheckBuffer(+o) || !Arena::local().scopes) return false;
+        Buffer buff(+o, PyBUF_SIMPLE);
+        if (!buff) return PyErr_Clear(), false;
+        auto const &view = pin_buffer(std::move(buff)).view;
+        return v.emplace(Type<BinaryView>(), static_cast<BinaryType const *>(view.buf), static_cast<std::size_t>(view.len)), true;
+    }
+
+    if (t.equals<BinaryData>()) {
+        // BinaryData is mutable, so it is only made from exporters which grant a writable buffer:
+        // bytes and other read-only objects are viewed as BinaryView instead
+        if (PyBytes_Check(+o) || !PyObject_CheckBuffer(+o)) return false;
+        // The buffer is pinned in the call arena, so that the data can be neither resized nor
+        // released before the call finishes; outside of a call there is nowhere to pin it
+        if (!Arena::local().scopes) return false;
+        Buffer buff(+o, PyBUF_SIMPLE | PyBUF_WRITABLE);
+        if (!buff) return PyErr_Clear(), false;
+        auto const &view = pin_buffer(std::move(buff)).view;
+        return v.emplace(Type<BinaryData>(), static_cast<BinaryType *>(view.buf), static_cast<std::size_t>(view.len)), true;
+    }
+
     if (t.equals<ArrayView>()) {
         if (PyObject_CheckBuffer(+o)) {
             // Read in the shape but ignore strides, suboffsets
             DUMP("cast buffer", reference_count(o));
-            if (auto buff = Buffer(o, PyBUF_FULL_RO)) {
+            // PyBUF_WRITABLE is not requested: a read-only exporter would raise for it on every call,
+            // and exporters report whether the data is writable in readonly anyway. A mutable target
+            // (e.g. Span<T> of non-const T) then fails on a read-only array in array_target()
+            if (auto local = Buffer(+o, PyBUF_FULL_RO)) {
+                // Within a call the buffer stays exported until the call returns, even with the GIL released.
+                // Otherwise it is released on return here, and the view must not be written through
+                bool const pinned = Arena::local().scopes;
+                auto &buff = pinned ? pin_buffer(std::move(local)) : local;
                 DUMP("making data", reference_count(o));
-                DUMP(Buffer::format(buff.view.format ? buff.view.format : "").name());
+                auto const format = Buffer::parse(buff.view.format ? buff.view.format : "B");
+                DUMP(format ? format.type->name() : "unsupported format");
                 DUMP("ndim", buff.view.ndim);
                 DUMP((nullptr == buff.view.buf), bool(buff.view.readonly));
-                for (auto i = 0; i != buff.view.ndim; ++i) DUMP(i, buff.view.shape[i], buff.view.strides[i]);
                 DUMP("itemsize", buff.view.itemsize);
+                // A repeat count becomes a trailing contiguous dimension
+                bool const ok = format && static_cast<std::size_t>(buff.view.itemsize) == format.itemsize;
+                bool const repeat = ok && format.count > 1 && *format.type != typeid(char[]);
+                auto const elem = repeat ? buff.view.itemsize / format.count : buff.view.itemsize;
                 ArrayLayout lay;
-                lay.contents.reserve(buff.view.ndim);
-                for (std::size_t i = 0; i != buff.view.ndim; ++i)
-                    lay.contents.emplace_back(buff.view.shape[i], buff.view.strides[i] / buff.view.itemsize);
+                lay.contents.resize(buff.view.ndim + repeat);
+                if (repeat) lay.contents.back() = {format.count, 1};
+                // Exporters such as ctypes may leave strides null for C-contiguous data
+                std::ptrdiff_t contiguous = repeat ? format.count : 1;
+                for (auto i = buff.view.ndim; i--;) {
+                    auto const stride = buff.view.strides ? buff.view.strides[i] / elem : contiguous;
+                    lay.contents[i] = {buff.view.shape[i], stride};
+                    contiguous *= buff.view.shape[i];
+                }
                 DUMP("layout", lay, reference_count(o));
                 DUMP("depth", lay.depth());
-                ArrayData data{buff.view.buf, buff.view.format ? &Buffer::format(buff.view.format) : &typeid(void), !buff.view.readonly};
+                ArrayData data{buff.view.buf, ok ? format.type : &typeid(void), pinned && !buff.view.readonly, ok && format.swap};
                 return v.emplace(Type<ArrayView>(), std::move(data), std::move(lay)), true;
             } else throw python_error(type_error("C++: could not get buffer"));
         } else return false;
@@ -209,9 +500,9 @@ bool object_response(Variable &v, TypeIndex t, Object o) {
 
 std::string get_type_name(TypeIndex idx) noexcept {
     std::string out;
-    auto it = type_names.find(idx);
-    if (it == type_names.end() || it->second.empty()) out = idx.name();
-    else out = it->second;
+    auto p = type_names.find(+idx);
+    if (!p || p->empty()) out = idx.name();
+    else out = *p;
     out += QualifierSuffixes[static_cast<unsigned char>(idx.qualifier())];
     return out;
 }
@@ -258,6 +549,12 @@ void args_from_python(Sequence &v, Object const &args) {
     map_iterable(args, [&v](Object o) {v.emplace_back(variable_reference_from_object(std::move(o)));});
 }
 
+// Store the objects in the array args[0:n] in pack
+void args_from_python(Sequence &v, PyObject *const *args, std::size_t n) {
+    v.reserve(v.size() + n);
+    for (auto it = args; it != args + n; ++it) v.emplace_back(variable_reference_from_object({*it, true}));
+}
+
 /******************************************************************************/
 
 }
@@ -1,4 +1,26 @@
 #include <rebind/Document.h>
+#include <rebind/MappedFile.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <complex>
+#include <cerrno>
+#include <cmath>
+#include <limits>
+
+#if __has_include(<sys/mman.h>)
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#   define REBIND_MMAP 1
+#else
+#   define REBIND_MMAP 0
+#endif
 
 /******************************************************************************/
 
@@ -43,6 +65,37 @@ std::string demangle(char const *s) {
 
 /******************************************************************************/
 
+namespace {
+
+/// Process-wide type registry. Leaked so it can be used during static initialization and destruction
+struct TypeRegistry {
+    std::mutex mutex;
+    std::unordered_map<std::type_index, std::uint32_t> ids;
+};
+
+TypeRegistry &type_registry() {
+    static TypeRegistry &r = *new TypeRegistry;
+    return r;
+}
+
+}
+
+std::uint32_t intern_type(std::type_info const &t) {
+    // type_info objects may be duplicated across shared objects, so the registry is keyed by std::type_index,
+    // while each thread caches the lookup by address
+    thread_local std::unordered_map<std::type_info const *, std::uint32_t> cache;
+    if (auto it = cache.find(&t); it != cache.end()) return it->second;
+    auto &r = type_registry();
+    std::uint32_t id;
+    {
+        std::lock_guard<std::mutex> lk(r.mutex);
+        id = r.ids.try_emplace(std::type_index(t), static_cast<std::uint32_t>(r.ids.size() + 1)).first->second;
+    }
+    cache.emplace(&t, id);
+    return id;
+}
+
+
 bool Debug = false;
 
 void set_debug(bool debug) noexcept {Debug = debug;}
@@ -50,8 +103,361 @@ bool debug() noexcept {return Debug;}
 
 /******************************************************************************/
 
+Arena &Arena::local() noexcept {
+    thread_local Arena arena;
+    return arena;
+}
+
+/******************************************************************************/
+
+#ifndef REBIND_POOL
+#   define REBIND_POOL 1
+#endif
+
+namespace {
+
+constexpr std::size_t pool_granularity = 16, pool_classes = 16; // size classes of 16 to 256 bytes
+constexpr std::size_t pool_batch = 32; // blocks moved at once between a thread cache and the central pool
+constexpr std::size_t pool_cache_limit = 128; // blocks per size class kept by a thread cache
+constexpr std::size_t pool_slab = 1 << 16;
+
+struct PoolBlock {PoolBlock *next;};
+
+/// Blocks shared between threads, and the slabs they are carved from (which are never released)
+struct CentralPool {
+    std::mutex mutex;
+    PoolBlock *free[pool_classes] = {};
+    unsigned char *slab = nullptr;
+    std::size_t slab_left = 0;
+    std::atomic<std::size_t> hits{0}, misses{0}, oversize{0};
+
+    /// Push n blocks of size class c onto list
+    void take(std::size_t c, PoolBlock *&list, std::size_t n) {
+        std::size_t const size = (c + 1) * pool_granularity;
+        std::lock_guard<std::mutex> lk(mutex);
+        for (; n && free[c]; --n) {
+            PoolBlock *b = free[c];
+            free[c] = b->next;
+            b->next = list;
+            list = b;
+        }
+        for (; n; --n) {
+            if (slab_left < size) {
+                slab = static_cast<unsigned char *>(::operator new(pool_slab));
+                slab_left = pool_slab;
+            }
+            auto b = reinterpret_cast<PoolBlock *>(slab);
+            slab += size;
+            slab_left -= size;
+            b->next = list;
+            list = b;
+        }
+    }
+
+    /// Return the chain of blocks from first to last
+    void give(std::size_t c, PoolBlock *first, PoolBlock *last) {
+        std::lock_guard<std::mutex> lk(mutex);
+        last->next = free[c];
+        free[c] = first;
+    }
+};
+
+/// Leaked so that it outlives every thread cache
+CentralPool &central_pool() {
+    static CentralPool &pool = *new CentralPool;
+    return pool;
+}
+
+struct ThreadPool {
+    PoolBlock *free[pool_classes] = {};
+    std::size_t count[pool_classes] = {};
+    std::size_t hits = 0, misses = 0, oversize = 0;
+
+    void *allocate(std::size_t c) {
+        if (free[c]) ++hits;
+        else {
+            central_pool().take(c, free[c], pool_batch);
+            count[c] += pool_batch;
+            ++misses;
+            flush_statistics();
+        }
+        PoolBlock *b = free[c];
+        free[c] = b->next;
+        --count[c];
+        return b;
+    }
+
+    void deallocate(void *p, std::size_t c) noexcept {
+        auto b = static_cast<PoolBlock *>(p);
+        b->next = free[c];
+        free[c] = b;
+        if (++count[c] > pool_cache_limit) release(c, pool_cache_limit / 2);
+    }
+
+    /// Return all but keep blocks of size class c to the central pool
+    void release(std::size_t c, std::size_t keep) noexcept {
+        if (count[c] <= keep) return;
+        PoolBlock *first = free[c], *last = first;
+        for (std::size_t i = count[c] - keep; --i;) last = last->next;
+        free[c] = last->next;
+        count[c] = keep;
+        central_pool().give(c, first, last);
+    }
+
+    void flush_statistics() noexcept {
+        auto &central = central_pool();
+        central.hits.fetch_add(std::exchange(hits, 0), std::memory_order_relaxed);
+        central.misses.fetch_add(std::exchange(misses, 0), std::memory_order_relaxed);
+        central.oversize.fetch_add(std::exchange(oversize, 0), std::memory_order_relaxed);
+    }
+
+    ~ThreadPool();
+};
+
+thread_local bool thread_pool_destroyed = false; // trivially destructible, so valid until the thread ends
+
+ThreadPool::~ThreadPool() {
+    for (std::size_t c = 0; c != pool_classes; ++c) release(c, 0);
+    flush_statistics();
+    thread_pool_destroyed = true;
+}
+
+/// Cache of the calling thread, or null if it has already been destroyed (during thread exit)
+ThreadPool *thread_pool() noexcept {
+    if (thread_pool_destroyed) return nullptr;
+    thread_local ThreadPool pool;
+    return &pool;
+}
+
+}
+
+void *allocate_payload(std::size_t n) {
+#if REBIND_POOL
+    if (n && n <= pool_granularity * pool_classes) {
+        std::size_t const c = (n - 1) / pool_granularity;
+        if (auto p = thread_pool()) return p->allocate(c);
+        PoolBlock *b = nullptr;
+        central_pool().take(c, b, 1);
+        return b;
+    }
+    if (auto p = thread_pool()) ++p->oversize;
+    else central_pool().oversize.fetch_add(1, std::memory_order_relaxed);
+#endif
+    return ::operator new(n);
+}
+
+void deallocate_payload(void *p, std::size_t n) noexcept {
+#if REBIND_POOL
+    if (n && n <= pool_granularity * pool_classes) {
+        std::size_t const c = (n - 1) / pool_granularity;
+        if (auto t = thread_pool()) t->deallocate(p, c);
+        else central_pool().give(c, static_cast<PoolBlock *>(p), static_cast<PoolBlock *>(p));
+        return;
+    }
+#endif
+    ::operator delete(p);
+}
+
+PoolStatistics pool_statistics() noexcept {
+    PoolStatistics s;
+#if REBIND_POOL
+    auto const &central = central_pool();
+    s.hits = central.hits.load(std::memory_order_relaxed);
+    s.misses = central.misses.load(std::memory_order_relaxed);
+    s.oversize = central.oversize.load(std::memory_order_relaxed);
+    if (auto p = thread_pool()) {
+        s.hits += p->hits;
+        s.misses += p->misses;
+        s.oversize += p->oversize;
+    }
+#endif
+    return s;
+}
+
+/******************************************************************************/
+
+struct MappedFile::Mapping {
+    BinaryType *data = nullptr;
+    std::size_t size = 0;
+    bool writable = false;
+
+    Mapping(std::string const &path, bool write) : writable(write) {
+#if REBIND_MMAP
+        int const fd = ::open(path.c_str(), write ? O_RDWR : O_RDONLY);
+        if (fd < 0) throw std::runtime_error("could not open " + path + ": " + std::strerror(errno));
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            int const e = errno;
+            ::close(fd);
+            throw std::runtime_error("could not stat " + path + ": " + std::strerror(e));
+        }
+        size = static_cast<std::size_t>(st.st_size);
+        if (size) {
+            void *p = ::mmap(nullptr, size, write ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+            int const e = errno;
+            ::close(fd); // the mapping keeps its own reference to the file
+            if (p == MAP_FAILED) throw std::runtime_error("could not map " + path + ": " + std::strerror(e));
+            data = static_cast<BinaryType *>(p);
+        } else ::close(fd);
+#else
+        throw std::runtime_error("memory-mapped files are not supported on this platform");
+#endif
+    }
+
+    Mapping(Mapping const &) = delete;
+    Mapping &operator=(Mapping const &) = delete;
+
+    ~Mapping() {
+#if REBIND_MMAP
+        if (data) ::munmap(data, size);
+#endif
+    }
+};
+
+namespace {
+
+/// Element type and size for a NumPy type string such as "<f8"; byte order is returned in swap
+std::pair<std::type_info const *, std::size_t> parse_dtype(std::string_view s, bool &swap) {
+    std::uint16_t const one = 1;
+    bool const little = *reinterpret_cast<unsigned char const *>(&one);
+    swap = false;
+    if (!s.empty() && (s[0] == '<' || s[0] == '>' || s[0] == '|' || s[0] == '=')) {
+        swap = (s[0] == '<' && !little) || (s[0] == '>' && little);
+        s.remove_prefix(1);
+    }
+    if (s.size() < 2) return {nullptr, 0};
+    std::size_t n = 0;
+    for (char c : s.substr(1)) {
+        if (c < '0' || c > '9') return {nullptr, 0};
+        n = 10 * n + (c - '0');
+    }
+    ScalarKind kind = ScalarKind::none;
+    switch (s[0]) {
+        case 'b': kind = ScalarKind::boolean; break;
+        case 'i': kind = ScalarKind::signed_integer; break;
+        case 'u': kind = ScalarKind::unsigned_integer; break;
+        case 'f': kind = ScalarKind::floating; break;
+        case 'c': kind = ScalarKind::complex; break;
+    }
+    auto const t = scalar_type(kind, n);
+    if (n == 1) swap = false;
+    return {t, t ? n : 0};
+}
+
+}
+
+MappedFile::MappedFile(std::string const &path, bool writable)
+    : m_map(std::make_shared<Mapping const>(path, writable)), m_size(m_map->size) {}
+
+bool MappedFile::writable() const noexcept {return m_map && m_map->writable;}
+
+BinaryType const *MappedFile::data() const noexcept {return m_map ? m_map->data + m_offset : nullptr;}
+
+BinaryData MappedFile::binary() const {
+    if (!writable()) throw std::invalid_argument("mapped file is read-only");
+    return {m_map->data + m_offset, m_size};
+}
+
+ArrayView MappedFile::array() const {
+    ArrayData d{m_map ? m_map->data + m_offset : nullptr, m_type, writable(), m_swap};
+    if (m_shape.empty()) return {d, ArrayLayout(m_size / m_itemsize)};
+    Vector<std::ptrdiff_t> strides(m_shape.size());
+    std::ptrdiff_t stride = 1;
+    for (auto i = m_shape.size(); i--;) {strides[i] = stride; stride *= m_shape[i];}
+    return {d, ArrayLayout(m_shape, strides)};
+}
+
+MappedFile MappedFile::as_array(std::string_view dtype, Vector<std::size_t> shape) const {
+    MappedFile out = *this;
+    std::tie(out.m_type, out.m_itemsize) = parse_dtype(dtype, out.m_swap);
+    if (!out.m_type) throw std::invalid_argument("unsupported array type string " + std::string(dtype));
+    if (reinterpret_cast<std::uintptr_t>(data()) % out.m_itemsize)
+        throw std::invalid_argument("mapped window is not aligned to its element type");
+    std::size_t n = 1;
+    for (auto i : shape) n *= i;
+    if (shape.empty()) n = m_size / out.m_itemsize;
+    if (n * out.m_itemsize > m_size) throw std::invalid_argument("array shape is larger than the mapped window");
+    out.m_shape = std::move(shape);
+    return out;
+}
+
+MappedFile MappedFile::window(std::size_t offset, std::size_t n) const {
+    MappedFile out;
+    out.m_map = m_map;
+    out.m_offset = m_offset + std::min(offset, m_size);
+    out.m_size = std::min(n, m_size - std::min(offset, m_size));
+    return out;
+}
+
+Vector<MappedFile> MappedFile::chunks(std::size_t n) const {
+    Vector<MappedFile> out;
+    out.reserve(chunk_count(n));
+    for (std::size_t i = 0; i != chunk_count(n); ++i) out.emplace_back(chunk(i, n));
+    return out;
+}
+
+#if REBIND_MMAP
+namespace {
+
+/// Page-aligned extent of a window, as madvise and msync require
+std::pair<void *, std::size_t> page_range(BinaryType const *p, std::size_t n) noexcept {
+    auto const page = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+    auto const begin = reinterpret_cast<std::uintptr_t>(p) & ~(page - 1);
+    return {reinterpret_cast<void *>(begin), reinterpret_cast<std::uintptr_t>(p) + n - begin};
+}
+
+}
+#endif
+
+void MappedFile::advise(std::string_view hint) const {
+#if REBIND_MMAP
+    int advice;
+    if (hint == "normal") advice = MADV_NORMAL;
+    else if (hint == "random") advice = MADV_RANDOM;
+    else if (hint == "sequential") advice = MADV_SEQUENTIAL;
+    else if (hint == "willneed") advice = MADV_WILLNEED;
+    else if (hint == "dontneed") advice = MADV_DONTNEED;
+    else throw std::invalid_argument("unknown madvise hint " + std::string(hint));
+    if (!m_size) return;
+    auto const r = page_range(data(), m_size);
+    if (::madvise(r.first, r.second, advice) != 0)
+        throw std::runtime_error(std::string("madvise failed: ") + std::strerror(errno));
+#endif
+}
+
+void MappedFile::flush() const {
+#if REBIND_MMAP
+    if (!m_size || !writable()) return;
+    auto const r = page_range(data(), m_size);
+    if (::msync(r.first, r.second, MS_SYNC) != 0)
+        throw std::runtime_error(std::string("msync failed: ") + std::strerror(errno));
+#endif
+}
+
+void render(Document &doc, Type<MappedFile> t) {
+    doc.type(t, "MappedFile");
+    doc.method(t, "new", [](std::string const &path) {return MappedFile(path);});
+    doc.method(t, "new", [](std::string const &path, bool writable) {return MappedFile(path, writable);});
+    doc.method(t, "size", &MappedFile::size);
+    doc.method(t, "writable", &MappedFile::writable);
+    doc.method(t, "as_array", [](MappedFile const &f, std::string_view dtype) {return f.as_array(dtype);});
+    doc.method(t, "as_array", &MappedFile::as_array);
+    doc.method(t, "window", &MappedFile::window);
+    doc.method(t, "chunk_count", &MappedFile::chunk_count);
+    doc.method(t, "chunk", &MappedFile::chunk);
+    doc.method(t, "chunks", &MappedFile::chunks);
+    doc.method(t, "advise", &MappedFile::advise);
+    doc.method(t, "flush", &MappedFile::flush);
+}
+
+/******************************************************************************/
+
 Document & document() noexcept {
-    static Document static_document;
+    static Document static_document = [] {
+        Document doc;
+        doc.render(Type<MappedFile>());
+        return doc;
+    }();
     return static_document;
 }
 
@@ -89,8 +495,7 @@ void Variable::assign(Variable v) {
             *this = std::move(v);
         } else {
             DUMP("assign1");
-            if (auto p = handle())
-                act(ActionType::destroy, pointer(), nullptr);
+            destroy();
             // Copy data but set the qualifier to Value
             static_cast<VariableData &>(*this) = v;
             idx.set_qualifier(Value);
@@ -98,7 +503,7 @@ void Variable::assign(Variable v) {
             // DUMP(&v, v.pointer());
             // e.g. value = lvalue which means
             // Move variable if it held RValue
-            act((v.qualifier() == Rvalue) ? ActionType::move : ActionType::copy, v.pointer(), this);
+            (v.qualifier() == Rvalue) ? act->move(v.pointer(), this) : act->copy(v.pointer(), this);
             // DUMP(stack, v.stack);
         }
     } else if (qualifier() == Const) {
@@ -107,7 +512,7 @@ void Variable::assign(Variable v) {
     } else { // qual == Lvalue or Rvalue
         DUMP("assigning reference ", type(), " ", &buff, " ", pointer(), " ", v.type());
         // qual, type, etc are unchanged
-        act(ActionType::assign, pointer(), &v);
+        act->assign(pointer(), &v);
         if (v.has_value())
             throw std::invalid_argument("Could not coerce Variable to matching type");
     }
@@ -115,6 +520,55 @@ void Variable::assign(Variable v) {
 
 /******************************************************************************/
 
+struct RouteKey {
+    std::type_info const *held;
+    TypeIndex target;
+    Qualifier source;
+
+    bool operator==(RouteKey const &k) const {return held == k.held && target == k.target && source == k.source;}
+};
+
+struct RouteHash {
+    std::size_t operator()(RouteKey const &k) const {
+        return std::hash<std::type_info const *>()(k.held) ^ (k.target.hash_code() << 1)
+            ^ (static_cast<std::size_t>(k.target.qualifier()) << 2 | k.source);
+    }
+};
+
+/// Process-wide record of which Responses succeeded or failed. Recorded routes never change,
+/// so each thread keeps its own copy of the routes it has looked up and only reads the shared
+/// map, under the lock, on a miss. A miss is remembered until another route is recorded
+static std::shared_mutex route_mutex;
+static std::unordered_map<RouteKey, bool, RouteHash> routes;
+static std::atomic<std::size_t> route_version{0};
+
+struct CachedRoute {
+    Route route;
+    std::size_t version; //< route_version when an unknown route was looked up
+};
+
+Route response_route(std::type_info const &held, TypeIndex const &target, Qualifier source) {
+    thread_local std::unordered_map<RouteKey, CachedRoute, RouteHash> local;
+    RouteKey key{&held, target, source};
+    auto const version = route_version.load(std::memory_order_acquire);
+    auto &c = local.try_emplace(key, CachedRoute{Route::unknown, version - 1}).first->second;
+    if (c.route != Route::unknown || c.version == version) return c.route;
+
+    std::shared_lock<std::shared_mutex> lk(route_mutex);
+    auto it = routes.find(key);
+    c.version = version;
+    if (it != routes.end()) c.route = it->second ? Route::possible : Route::impossible;
+    return c.route;
+}
+
+void set_response_route(std::type_info const &held, TypeIndex const &target, Qualifier source, bool ok) {
+    std::unique_lock<std::shared_mutex> lk(route_mutex);
+    if (routes.try_emplace(RouteKey{&held, target, source}, ok).second)
+        route_version.fetch_add(1, std::memory_order_release);
+}
+
+/******************************************************************************/
+
 Variable Variable::request_var(Dispatch &msg, TypeIndex const &t, Qualifier q) const {
     DUMP((act != nullptr), " asking for ", t, " from ", q, " ", type());
     Variable v;
@@ -126,7 +580,7 @@ Variable Variable::request_var(Dispatch &msg, TypeIndex const &t, Qualifier q) c
             v.idx = t;
             v.act = act;
             v.stack = stack;
-            act((q == Rvalue) ? ActionType::move : ActionType::copy, pointer(), &v);
+            (q == Rvalue) ? act->move(pointer(), &v) : act->copy(pointer(), &v);
         } else if (t.qualifier() == Const || t.qualifier() == q) { // Bind a reference
             // DUMP("yope", t, type(), q);
             reinterpret_cast<void *&>(v.buff) = pointer();
@@ -137,9 +591,12 @@ Variable Variable::request_var(Dispatch &msg, TypeIndex const &t, Qualifier q) c
             // DUMP("nope");
             msg.error("Source and target qualifiers are not compatible");
         }
+    } else if (auto const route = response_route(idx.info(), t, q); route == Route::impossible) {
+        DUMP("response is known to be impossible");
+        set_source(msg, idx.info(), Variable());
     } else {
-        ::new(static_cast<void *>(&v.buff)) RequestData{t, &msg, q};
-        act(ActionType::response, pointer(), &v);
+        ::new(static_cast<void *>(&v.buff)) RequestData{t, &msg, q, route};
+        act->response(pointer(), &v);
         // DUMP(v.has_value(), v.name(), q, v.qualifier());
 
         if (!v.has_value()) {
@@ -157,15 +614,175 @@ Variable Variable::request_var(Dispatch &msg, TypeIndex const &t, Qualifier q) c
 
 /******************************************************************************/
 
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__linux__) && !defined(REBIND_NO_TARGET_CLONES)
+#   define REBIND_TARGET_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#   define REBIND_TARGET_CLONES
+#endif
+
+namespace {
+
+using ConvertibleScalars = Pack<bool, char, signed char, unsigned char, char16_t, char32_t,
+    short, unsigned short, int, unsigned int, long, unsigned long, long long, unsigned long long,
+    float, double, long double>;
+
+/// Whether some values of F have no exact T equivalent, so that each element is checked (bool
+/// targets are not checked: any nonzero value is true, as in a static_cast)
+template <class F, class T>
+static constexpr bool checked_conversion = std::is_integral_v<T> && !std::is_same_v<T, bool>
+    && (std::is_floating_point_v<F> || std::numeric_limits<F>::digits > std::numeric_limits<T>::digits
+        || (std::is_signed_v<F> && !std::is_signed_v<T>));
+
+/// Whether x converts to T exactly: in range and, if floating point, an integer (so never NaN or inf)
+template <class T, class F>
+bool exactly_convertible(F x) noexcept {
+    if constexpr(!checked_conversion<F, T>) return true;
+    else if constexpr(std::is_floating_point_v<F>) {
+        // both bounds are exact powers of 2 (or 0) in F
+        return x >= static_cast<F>(std::numeric_limits<T>::min())
+            && x < std::ldexp(F(1), std::numeric_limits<T>::digits) && x == std::trunc(x);
+    } else if constexpr(std::is_signed_v<F>) {
+        if (x < 0) return std::is_signed_v<T> && static_cast<long long>(x) >= static_cast<long long>(std::numeric_limits<T>::min());
+        return static_cast<unsigned long long>(x) <= static_cast<unsigned long long>(std::numeric_limits<T>::max());
+    } else return static_cast<unsigned long long>(x) <= static_cast<unsigned long long>(std::numeric_limits<T>::max());
+}
+
+/// Contiguous conversion, unrolled in fixed blocks so that it is vectorized at -O2.
+/// On x86-64 an AVX2 clone is selected at load time; SSE2 and NEON are used by the default build.
+/// Returns false, leaving out partly written, if an element is not exactly convertible
+template <class F, class T>
+REBIND_TARGET_CLONES
+bool convert_contiguous(T *__restrict out, F const *__restrict in, std::size_t n) noexcept {
+    if constexpr(checked_conversion<F, T>) { // a separate pass, so that both loops stay branch free
+        bool ok = true;
+        for (std::size_t i = 0; i != n; ++i) ok &= exactly_convertible<T>(in[i]);
+        if (!ok) return false;
+    }
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+        for (std::size_t j = 0; j != 16; ++j) out[i + j] = static_cast<T>(in[i + j]);
+    for (; i != n; ++i) out[i] = static_cast<T>(in[i]);
+    return true;
+}
+
+template <class F>
+F byteswapped(F const &x) noexcept {
+    unsigned char b[sizeof(F)];
+    std::memcpy(b, &x, sizeof(F));
+    std::reverse(std::begin(b), std::end(b));
+    F out;
+    std::memcpy(&out, b, sizeof(F));
+    return out;
+}
+
+/// Convert n elements at in[offset], in[offset + stride], ... into contiguous out, or return false
+/// if one is not exactly convertible
+using ConvertFunction = bool (*)(void *, void const *, std::ptrdiff_t, std::size_t, std::ptrdiff_t, bool);
+
+template <class F, class T>
+bool convert_kernel(void *out, void const *in, std::ptrdiff_t offset, std::size_t n, std::ptrdiff_t stride, bool swap) noexcept {
+    auto o = static_cast<T *>(out);
+    auto i = static_cast<F const *>(in) + offset;
+    if (!swap && stride == 1) return convert_contiguous(o, i, n);
+    for (std::size_t k = 0; k != n; ++k) {
+        F const x = swap ? byteswapped(i[k * stride]) : i[k * stride];
+        if (!exactly_convertible<T>(x)) return false;
+        o[k] = static_cast<T>(x);
+    }
+    return true;
+}
+
+template <class F, class ...Ts>
+constexpr std::array<ConvertFunction, sizeof...(Ts)> convert_row(Pack<Ts...>) {return {&convert_kernel<F, Ts>...};}
+
+template <class ...Ts>
+constexpr std::array<std::array<ConvertFunction, sizeof...(Ts)>, sizeof...(Ts)> convert_table(Pack<Ts...> p) {
+    return {convert_row<Ts>(p)...};
+}
+
+constexpr auto convert_functions = convert_table(ConvertibleScalars());
+
+template <class ...Ts>
+constexpr std::array<std::size_t, sizeof...(Ts)> scalar_size_table(Pack<Ts...>) {return {sizeof(Ts)...};}
+
+constexpr auto scalar_sizes = scalar_size_table(ConvertibleScalars());
+
+/// Position of a type in ConvertibleScalars, or -1
+template <class ...Ts>
+int scalar_position(std::type_info const &t, Pack<Ts...>) noexcept {
+    int i = 0, out = -1;
+    ((t == typeid(Ts) ? (out = i, true) : (++i, false)) || ...);
+    return out;
+}
+
+}
+
+ArrayConversion convert_array(void *out, std::type_info const &to, ArrayData const &data, ArrayLayout const &layout) {
+    int const t = scalar_position(to, ConvertibleScalars()), f = scalar_position(data.type(), ConvertibleScalars());
+    if (t < 0 || f < 0) return ArrayConversion::unsupported;
+    auto const fun = convert_functions[f][t];
+    std::size_t const n = layout.n_elem(), d = layout.depth();
+    if (!n) return ArrayConversion::done;
+    if (layout.row_major())
+        return fun(out, data.pointer(), 0, n, 1, data.swapped()) ? ArrayConversion::done : ArrayConversion::inexact;
+    // Otherwise convert one row of the last dimension at a time, in row major order
+    std::size_t const inner = layout.shape(d - 1), row_bytes = inner * scalar_sizes[t];
+    Vector<std::size_t> index(d - 1, 0);
+    std::ptrdiff_t offset = 0;
+    for (auto o = static_cast<unsigned char *>(out);; o += row_bytes) {
+        if (!fun(o, data.pointer(), offset, inner, layout.stride(d - 1), data.swapped())) return ArrayConversion::inexact;
+        std::size_t i = d - 1;
+        for (; i--;) { // odometer increment of the outer multi-index
+            offset += layout.stride(i);
+            if (++index[i] != layout.shape(i)) break;
+            offset -= layout.stride(i) * static_cast<std::ptrdiff_t>(index[i]);
+            index[i] = 0;
+        }
+        if (i == std::size_t(-1)) return ArrayConversion::done;
+    }
+}
+
+std::type_info const *scalar_type(ScalarKind kind, std::size_t size) noexcept {
+    switch (kind) {
+        case ScalarKind::boolean: return size == sizeof(bool) ? &typeid(bool) : nullptr;
+        case ScalarKind::character: return size == 1 ? &typeid(char) : nullptr;
+        case ScalarKind::string: return size == 1 ? &typeid(char[]) : nullptr;
+        case ScalarKind::signed_integer: switch (size) {
+            case 1: return &typeid(std::int8_t);
+            case 2: return &typeid(std::int16_t);
+            case 4: return &typeid(std::int32_t);
+            case 8: return &typeid(std::int64_t);
+        } break;
+        case ScalarKind::unsigned_integer: switch (size) {
+            case 1: return &typeid(std::uint8_t);
+            case 2: return &typeid(std::uint16_t);
+            case 4: return &typeid(std::uint32_t);
+            case 8: return &typeid(std::uint64_t);
+        } break;
+        case ScalarKind::floating: switch (size) {
+            case sizeof(float): return &typeid(float);
+            case sizeof(double): return &typeid(double);
+        } break;
+        case ScalarKind::complex: switch (size) {
+            case 2 * sizeof(float): return &typeid(std::complex<float>);
+            case 2 * sizeof(double): return &typeid(std::complex<double>);
+        } break;
+        default: break;
+    }
+    return nullptr;
+}
+
+/******************************************************************************/
+
 void set_source(Dispatch &msg, std::type_info const &t, Variable &&v) {
     if (auto p = std::move(v).target<std::string &&>()) {
-        msg.source = std::move(*p);
+        msg.set_source(*p);
     } else if (auto p = v.target<std::string_view const &>()) {
-        msg.source = *p;
+        msg.set_source(*p);
     } else if (auto p = v.target<TypeIndex const &>()) {
-        msg.source = p->name();
+        msg.set_source(p->name());
     } else {
-        msg.source = t.name();
+        msg.set_source(t.name());
     }
 }
 
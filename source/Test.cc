@@ -1,7 +1,10 @@
 
 #include <rebind/Document.h>
-#include <rebind/Standard.h>
+#include <rebind/StandardTypes.h>
 #include <iostream>
+#include <numeric>
+#include <algorithm>
+#include <thread>
 
 namespace rebind {
 
@@ -22,7 +25,7 @@ template <class T>
 std::optional<Blah> request(Type<Blah>, T &&, Dispatch &msg) {
     if constexpr(std::is_same_v<unqualified<T>, std::string>)
         return Blah("haha");
-    return msg.error("bad blah", typeid(Blah));
+    return msg.error("bad blah", Type<Blah>());
 }
 
 //remove iostream
@@ -72,9 +75,7 @@ void render(Document &doc, Type<Goo> t) {
     doc.method(t, "{}", streamable(t));
 }
 
-// could make this return a document
-bool make_document() {
-    auto &doc = document();
+void init(Document &doc) {
     doc.function("fun", [](int i, double d) {
         return i + d;
     });
@@ -104,20 +105,115 @@ bool make_document() {
     doc.function("rref", [](double &&i) {});
     doc.render(Type<Goo>());
 
-    doc.function("buffer", [](std::tuple<BinaryData, std::type_index, Vector<std::size_t>> i) {
+    doc.function("buffer", [](std::tuple<BinaryView, std::type_index, Vector<std::size_t>> i) {
         DUMP(std::get<0>(i).size());
         DUMP(std::get<1>(i).name());
         DUMP(std::get<2>(i).size());
-        for (auto &c : std::get<0>(i)) c += 4;
+        std::size_t s = 0;
+        for (auto c : std::get<0>(i)) s += std::to_integer<std::size_t>(c);
+        return s;
     });
+    doc.function("binary_sum", [](BinaryView b) {
+        std::size_t s = 0;
+        for (auto c : b) s += std::to_integer<std::size_t>(c);
+        return s;
+    });
+    doc.function("binary_fill", [](BinaryData b) {std::fill(b.begin(), b.end(), std::byte{7});});
     doc.function("vec1", [](std::vector<int> const &) {});
     doc.function("vec2", [](std::vector<int> &) {});
     doc.function("vec3", [](std::vector<int>) {});
 
-    return bool();
-}
+    // Zero-copy array views
+    doc.function("span_sum", [](Span<double const> v) {return std::accumulate(v.begin(), v.end(), 0.0);});
+    doc.function("span_fill", [](Span<int> v) {std::fill(v.begin(), v.end(), 7);});
+    doc.function("span_sum_after", [](Span<double const> v, std::function<void()> f) {
+        f(); // the array stays exported, so f cannot resize it
+        return std::accumulate(v.begin(), v.end(), 0.0);
+    });
+    doc.function("strided_sum", [](StridedView<double const> v) {double s = 0; v.for_each([&](double x) {s += x;}); return s;});
+    doc.function("strided_at", [](StridedView<double const> v, std::size_t i, std::size_t j) {return v(i, j);});
+    // Arrays converted with the convert_array kernels when their elements are not exactly T
+    doc.function("converted_sum", [](ConvertedSpan<double> v) {return std::accumulate(v.begin(), v.end(), 0.0);});
+    doc.function("converted_ints", [](ConvertedSpan<int> v) {return std::vector<int>(v.begin(), v.end());});
+    doc.function("int_vector", [](std::vector<int> v) {return v;});
+    doc.function("unsigned_vector", [](std::vector<unsigned> v) {return v;});
+    doc.function("double_vector", [](std::vector<double> v) {return v;});
+    doc.function("string_vector", [](std::vector<std::string> v) {return std::accumulate(v.begin(), v.end(), std::string());});
+    doc.function("matrix_sum", [](ArrayRef<double const, 2> m) {double s = 0; m.for_each([&](double x) {s += x;}); return s;});
+    doc.function("matrix_at", [](ArrayRef<double const, 2> m, std::size_t i, std::size_t j) {return m(i, j) == m[i][j] ? m(i, j) : -1.0;});
+    doc.function("matrix_row_major", [](ArrayRef<double const, 2> m) {return m.is_row_major();});
+#if __cplusplus > 201703L && __has_include(<span>)
+    doc.function("std_span_sum", [](std::span<double const> v) {return std::accumulate(v.begin(), v.end(), 0.0);});
+#endif
+
+    // Held values exported through the buffer protocol and __array_interface__
+    static std::array<double, 6> const stored = {0, 1, 2, 3, 4, 5};
+    doc.function("every_other", [](bool reverse) {
+        return reverse ? StridedView<double const>(stored.data() + 5, ArrayLayout(std::array<std::size_t, 1>{3}, std::array<std::ptrdiff_t, 1>{-2}))
+                       : StridedView<double const>(stored.data(), ArrayLayout(std::array<std::size_t, 1>{3}, std::array<std::ptrdiff_t, 1>{2}));
+    });
+
+    // A Callback may only be invoked during the call which made it
+    static Callback<double> kept;
+    doc.function("keep", [](Callback<double> f) {kept = std::move(f); return kept(1.0);});
+    doc.function("call_kept", [] {return kept(2.0);});
+    doc.function("callback_from_thread", [](Callback<double> f) {
+        double out = 0;
+        std::exception_ptr error;
+        std::thread([&] {
+            try {out = f(3.0);}
+            catch (...) {error = std::current_exception();}
+        }).join();
+        if (error) std::rethrow_exception(error);
+        return out;
+    });
 
-// then this is just add_document()
-static bool static_document_trigger = make_document();
+    // Callbacks kept after the call, and invoked from worker threads
+    static PersistentCallback<double> persistent;
+    doc.function("persist", [](PersistentCallback<double> f) {persistent = std::move(f);});
+    doc.function("release_persistent", [] {std::thread([] {persistent = {};}).join();});
+    doc.function("run_persistent", [](std::size_t n) {
+        std::vector<std::thread> threads;
+        std::vector<double> out(n);
+        std::vector<std::exception_ptr> errors(n);
+        for (std::size_t i = 0; i != n; ++i) threads.emplace_back([&, i] {
+            try {out[i] = persistent(static_cast<double>(i));}
+            catch (...) {errors[i] = std::current_exception();}
+        });
+        for (auto &t : threads) t.join();
+        for (auto const &e : errors) if (e) std::rethrow_exception(e);
+        return std::accumulate(out.begin(), out.end(), 0.0);
+    });
+    doc.function("queue_from_threads", [](PersistentCallback<void> f, int n, std::size_t batch) {
+        CallbackQueue<int, std::string> q(std::move(f), batch);
+        std::vector<std::thread> threads;
+        for (int t = 0; t != 4; ++t)
+            threads.emplace_back([&, t] {for (int i = 0; i != n; ++i) q.push(t, std::to_string(i));});
+        for (auto &t : threads) t.join();
+        return q.flush();
+    });
+
+    // A Dispatch made outside of any CallScope must not free the allocations of an enclosing one
+    doc.function("nested_dispatch", [](unsigned n) {
+        bool ok = true;
+        std::thread([&] {
+            Dispatch outer;
+            {
+                Dispatch inner;
+                for (unsigned i = 0; i != n; ++i) outer.indices.push_back(i);
+                inner.error("inner");
+            }
+            Dispatch next;
+            next.error(std::string(8 * n, 'x'));
+            for (unsigned i = 0; i != n; ++i) ok = ok && outer.indices[i] == i;
+        }).join();
+        return ok;
+    });
+
+    // Overloads tried in declaration order; int only accepts floats with an integer value
+    doc.function("pick", [](int) {return std::string("int");});
+    doc.function("pick", [](double) {return std::string("double");});
+    doc.function("pick", [](std::string) {return std::string("string");});
+}
 
 }
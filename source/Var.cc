@@ -6,6 +6,10 @@ namespace rebind {
 PyObject * var_copy_assign(PyObject *self, PyObject *value) noexcept {
     return raw_object([=] {
         DUMP("- copying variable");
+        if (cast_object<Var>(self).buffer.exports) {
+            PyErr_SetString(PyExc_BufferError, "C++: cannot assign to an exported Variable");
+            throw python_error();
+        }
         cast_object<Var>(self).assign(variable_reference_from_object({value, true}));
         return Object(self, true);
     });
@@ -15,6 +19,14 @@ PyObject * var_move_assign(PyObject *self, PyObject *value) noexcept {
     return raw_object([=] {
         DUMP("- moving variable");
         auto &s = cast_object<Var>(self);
+        if (s.buffer.exports) {
+            PyErr_SetString(PyExc_BufferError, "C++: cannot assign to an exported Variable");
+            throw python_error();
+        }
+        if (auto p = cast_if<Var>(value); p && p->buffer.exports) {
+            PyErr_SetString(PyExc_BufferError, "C++: cannot move from an exported Variable");
+            throw python_error();
+        }
         Variable v = variable_reference_from_object({value, true});
         v.move_if_lvalue();
         s.assign(std::move(v));
@@ -38,7 +50,10 @@ PyObject * var_has_value(PyObject *self, PyObject *) noexcept {
 
 PyObject * var_cast(PyObject *self, PyObject *type) noexcept {
     return raw_object([=] {
-        return python_cast(std::move(cast_object<Variable>(self)), Object(type, true), Object(self, true));
+        auto &v = cast_object<Var>(self);
+        // An exported value must stay in place, so it is cast from a const reference rather than moved from
+        if (v.buffer.exports) return python_cast(static_cast<Variable const &>(v).reference(), Object(type, true), Object(self, true));
+        return python_cast(std::move(static_cast<Variable &>(v)), Object(type, true), Object(self, true));
     });
 }
 
@@ -105,13 +120,88 @@ PyObject * var_from(PyObject *cls, PyObject *obj) noexcept {
 
 /******************************************************************************/
 
+/// Export the held value through the buffer protocol if it can respond with an ArrayView.
+/// The layout is only recomputed when nothing else is exported, so live views stay valid
+int var_buffer(PyObject *self, Py_buffer *view, int flags) noexcept {
+    auto &v = cast_object<Var>(self);
+    if (!v.buffer.exports) {
+        PyObject *ok = raw_object([&]() -> Object {
+            if (auto p = v.reference().request<ArrayView>()) return v.buffer.view(*p), Object(Py_None, true);
+            PyErr_SetString(PyExc_BufferError, "C++: held value cannot be viewed as an array");
+            return {};
+        });
+        if (!ok) return -1;
+        Py_DECREF(ok);
+    }
+    return v.buffer.export_to(self, view, flags);
+}
+
+void var_buffer_release(PyObject *self, Py_buffer *) noexcept {
+    if (auto p = cast_if<Var>(self)) --p->buffer.exports;
+}
+
+PyBufferProcs VarBufferProcs{var_buffer, var_buffer_release};
+
+/// NumPy type string such as "<f8" for a PEP 3118 format code
+std::string array_typestr(std::string_view format, Py_ssize_t itemsize) {
+    std::uint16_t const one = 1;
+    char const order = itemsize == 1 ? '|' : (*reinterpret_cast<unsigned char const *>(&one) ? '<' : '>');
+    char kind = 'V';
+    if (format.front() == 'Z') kind = 'c';
+    else if (format.back() == '?') kind = 'b';
+    else if (format.back() == 'c') kind = 'S';
+    else if (std::string_view("bhilqn").find(format.back()) != std::string_view::npos) kind = 'i';
+    else if (std::string_view("BHILQNP").find(format.back()) != std::string_view::npos) kind = 'u';
+    else if (std::string_view("efdg").find(format.back()) != std::string_view::npos) kind = 'f';
+    return order + (kind + std::to_string(itemsize));
+}
+
+/// NumPy array interface (version 3) of the held value, made from the same layout as the buffer protocol.
+/// The data is given as a memoryview of self, so the Variable stays exported while NumPy uses it
+PyObject * var_array_interface(PyObject *self, void *) noexcept {
+    return raw_object([&]() -> Object {
+        auto data = Object::from(PyMemoryView_FromObject(self));
+        if (!data) return {};
+        Py_buffer const &view = *PyMemoryView_GET_BUFFER(+data);
+        auto shape = Object::from(PyTuple_New(view.ndim));
+        auto strides = Object::from(PyTuple_New(view.ndim));
+        Py_ssize_t lo = 0, hi = view.itemsize; // byte extent of the elements relative to view.buf
+        for (Py_ssize_t i = 0; i != view.ndim; ++i) {
+            PyTuple_SET_ITEM(+shape, i, PyLong_FromSsize_t(view.shape[i]));
+            PyTuple_SET_ITEM(+strides, i, PyLong_FromSsize_t(view.strides[i]));
+            if (view.shape[i]) (view.strides[i] < 0 ? lo : hi) += view.strides[i] * (view.shape[i] - 1);
+        }
+        if (!PyBuffer_IsContiguous(&view, 'C')) {
+            // NumPy takes a PyBUF_SIMPLE buffer of data, which a strided memoryview refuses. So the data is
+            // instead a flat byte buffer over the extent of the elements, which keeps the memoryview alive
+            auto flat = Object::from(PyObject_CallObject(type_object<ArrayBuffer>(), nullptr));
+            if (!flat) return {};
+            auto &b = cast_object<ArrayBuffer>(flat);
+            b.view(ArrayView{ArrayData(static_cast<char *>(view.buf) + lo, &typeid(unsigned char), !view.readonly),
+                             ArrayLayout(static_cast<std::size_t>(view.len ? hi - lo : 0))});
+            b.base = data;
+            swap(data, flat);
+        }
+        auto const typestr = array_typestr(view.format, view.itemsize);
+        return Object::from(Py_BuildValue("{s:O,s:s,s:O,s:O,s:n,s:i}", "shape", +shape, "typestr", typestr.c_str(),
+            "data", +data, "strides", +strides, "offset", -lo, "version", 3));
+    });
+}
+
+PyGetSetDef VarGetSet[] = {
+    {const_cast<char *>("__array_interface__"), var_array_interface, nullptr, const_cast<char *>("NumPy array interface of the held value"), nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr}
+};
+
+/******************************************************************************/
+
 PyNumberMethods VarNumberMethods = {
     .nb_bool = static_cast<inquiry>(var_bool),
 };
 
 PyMethodDef VarMethods[] = {
     {"copy_from",     static_cast<PyCFunction>(var_copy_assign),   METH_O,       "assign from other using C++ copy assignment"},
-    {"move_from",     static_cast<PyCFunction>(var_copy_assign),   METH_O,       "assign from other using C++ move assignment"},
+    {"move_from",     static_cast<PyCFunction>(var_move_assign),   METH_O,       "assign from other using C++ move assignment"},
     {"address",       static_cast<PyCFunction>(var_address),       METH_NOARGS,  "get C++ pointer address"},
     {"_ward",         static_cast<PyCFunction>(var_ward),          METH_NOARGS,  "get ward object"},
     {"_set_ward",     static_cast<PyCFunction>(var_set_ward),      METH_O,       "set ward object and return self"},
@@ -129,6 +219,8 @@ PyTypeObject Holder<Var>::type = []{
     auto o = type_definition<Var>("rebind.Variable", "C++ class object");
     o.tp_as_number = &VarNumberMethods;
     o.tp_methods = VarMethods;
+    o.tp_getset = VarGetSet;
+    o.tp_as_buffer = &VarBufferProcs;
     // no init (just use default constructor)
     // tp_traverse, tp_clear
     // PyMemberDef, tp_members